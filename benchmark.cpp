@@ -0,0 +1,522 @@
+// Benchmark of every algorithm of the repository over scalable graph families
+//
+// Compile with: g++ -O2 -std=c++17 -pthread benchmark.cpp solver_api.cpp -o benchmark
+// Run with: ./benchmark [--quick] [--perf] [--relabel METHOD] [output.json]
+//
+// Families: G(n,p), random chordal, grid (cartesian product of two paths)
+// and power-law (preferential attachment)
+// MIS and clique also run with --bitset 1, which leaves the whole graph to the
+// branching search, and above bitset_limit, where it takes the big nodes
+// For each algorithm, family and size it reports the wall time,
+// the nodes of the search and the nodes per second (0 for the algorithms
+// without a search tree) and the peak memory, as JSON
+// With --perf it also reads the hardware counters of each run (cycles,
+// instructions, L1 and LLC misses, branch misses and page faults)
+// with perf_event_open; counters the machine or kernel don't allow are left out
+// With --relabel each graph is renumbered by METHOD (see graph_relabel.h)
+// before the runs, so two reports show what the relabeling gains
+
+#include <iostream>
+#include <fstream>
+#include <set>
+#include <map>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <sys/resource.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <linux/perf_event.h>
+
+#include "graph_csr.h"
+#include "graph_formats.h"
+#include "graph_relabel.h"
+#include "graph_compressed.h"
+
+// The independent set, clique and matching tools come from the API,
+// the others are compiled here without their main functions,
+// each one in its own namespace, since they share names
+// Every header they use must be included above, out of the namespaces
+#include "solver_api.h"
+#define NO_MAIN
+namespace chordal {
+#include "check_cordability.cpp"
+}
+namespace fill {
+#include "chordalization.c"
+}
+namespace product {
+#include "cartesian_product.c"
+}
+#undef NO_MAIN
+
+// Graph as an adjacency matrix, the input of every tool
+struct Graph {
+	int n = 0;
+	long long m = 0;
+	std::vector<int> M; // M[i*n + j] = 1 if {i, j} is an edge
+
+	void init(int vertices) {
+		n = vertices;
+		m = 0;
+		M.assign((size_t) n * n, 0);
+	}
+
+	bool has(int i, int j) const {
+		return M[(size_t) i * n + j];
+	}
+
+	void add(int i, int j) {
+		if (i != j && !has(i, j)) {
+			M[(size_t) i * n + j] = M[(size_t) j * n + i] = 1;
+			m++;
+		}
+	}
+};
+
+// Generators
+
+// Erdos-Renyi G(n, p)
+Graph gnp(int n, double p, std::mt19937& rng) {
+	Graph g;
+	std::bernoulli_distribution coin(p);
+	g.init(n);
+	for (int i = 0; i < n; i++)
+		for (int j = i + 1; j < n; j++)
+			if (coin(rng))
+				g.add(i, j);
+	return g;
+}
+
+// Random chordal graph: each new vertex is connected to a random
+// subset of a clique that is already in the graph, so the
+// reverse of the insertion order is a perfect elimination order
+Graph random_chordal(int n, std::mt19937& rng) {
+	Graph g;
+	std::vector<std::vector<int>> clique(n); // clique[v] U {v} is a clique
+	g.init(n);
+	for (int v = 1; v < n; v++) {
+		int u = rng() % v;
+		std::vector<int> K = clique[u];
+		K.push_back(u);
+		for (int w : K) {
+			if (w == u || rng() % 2) {
+				g.add(v, w);
+				clique[v].push_back(w);
+			}
+		}
+	}
+	return g;
+}
+
+// Grid a x b as the cartesian product of two paths, built by cartProd
+Graph grid(int a, int b) {
+	Graph g;
+	std::vector<int> A(a * a, 0), B(b * b, 0);
+	for (int i = 0; i + 1 < a; i++)
+		A[i * a + i + 1] = A[(i + 1) * a + i] = 1;
+	for (int i = 0; i + 1 < b; i++)
+		B[i * b + i + 1] = B[(i + 1) * b + i] = 1;
+
+	int* P = product::cartProd(A.data(), B.data(), a, b);
+	g.init(a * b);
+	for (int i = 0; i < g.n; i++)
+		for (int j = i + 1; j < g.n; j++)
+			if (P[i * g.n + j])
+				g.add(i, j);
+	free(P);
+	return g;
+}
+
+// Power-law graph by preferential attachment, k edges per new vertex
+Graph power_law(int n, int k, std::mt19937& rng) {
+	Graph g;
+	std::vector<int> ends; // Each vertex appears once per edge it has
+	g.init(n);
+	for (int v = 1; v < n; v++) {
+		for (int e = 0; e < std::min(k, v); e++) {
+			int u = ends.empty() || rng() % 4 == 0 ? rng() % v : ends[rng() % ends.size()];
+			if (!g.has(u, v)) {
+				g.add(u, v);
+				ends.push_back(u);
+				ends.push_back(v);
+			}
+		}
+	}
+	return g;
+}
+
+// Measurements
+
+// Resets the peak memory of the process, so it can be read per run
+// Returns false if the kernel does not allow it
+bool reset_peak_memory() {
+	FILE* f = fopen("/proc/self/clear_refs", "w");
+	if (!f)
+		return false;
+	bool ok = fputs("5", f) >= 0;
+	return !fclose(f) && ok;
+}
+
+// Returns the peak resident memory in KB since the last reset,
+// or since the start of the process if it can't be reset
+long peak_memory_kb() {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line))
+		if (!line.compare(0, 6, "VmHWM:"))
+			return atol(line.c_str() + 6);
+
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_maxrss;
+}
+
+// Hardware counters of the process, read with perf_event_open
+// Each counter is opened alone, so the ones the CPU, the kernel
+// (perf_event_paranoid) or a virtual machine don't allow are just missing
+class PerfCounters {
+	struct Counter {
+		const char* name;
+		uint32_t type;
+		uint64_t config;
+		int fd;
+	};
+	std::vector<Counter> counters;
+
+	static uint64_t cache_event(uint64_t cache, uint64_t result) {
+		return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (result << 16);
+	}
+
+public:
+	PerfCounters() {
+		counters = {
+			{"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1},
+			{"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1},
+			{"l1d_misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS), -1},
+			{"llc_misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS), -1},
+			{"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1},
+			{"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, -1},
+		};
+
+		for (auto& c : counters) {
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = c.type;
+			attr.config = c.config;
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			// When there are more counters than registers the kernel
+			// multiplexes them, these times are used to scale the counts
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			c.fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		}
+	}
+
+	~PerfCounters() {
+		for (auto& c : counters)
+			if (c.fd >= 0)
+				close(c.fd);
+	}
+
+	// Returns true if at least one counter could be opened
+	bool available() const {
+		for (auto& c : counters)
+			if (c.fd >= 0)
+				return true;
+		return false;
+	}
+
+	void start() {
+		for (auto& c : counters) {
+			if (c.fd >= 0) {
+				ioctl(c.fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(c.fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+	}
+
+	// Stops the counters and returns the name and value of the ones that work
+	std::vector<std::pair<std::string, long long>> stop() {
+		std::vector<std::pair<std::string, long long>> values;
+		for (auto& c : counters) {
+			uint64_t data[3]; // value, time enabled, time running
+			if (c.fd < 0)
+				continue;
+			ioctl(c.fd, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(c.fd, data, sizeof(data)) != sizeof(data) || !data[2])
+				continue;
+			values.push_back({c.name, (long long) ((double) data[0] * data[1] / data[2])});
+		}
+		return values;
+	}
+};
+
+struct Result {
+	std::string algorithm, family;
+	int n;
+	long long m;
+	double param;
+	double time_ms;
+	long peak_kb;
+	long long answer; // Size of the set, matching or graph found
+	long long nodes; // Nodes of the search of the fastest run
+	std::vector<std::pair<std::string, long long>> counters; // Of the fastest run
+};
+
+long long run_nodes; // Nodes of the search of the last run, set by the algorithms that search
+
+// Runs f reps times and keeps the fastest run
+// If perf is not NULL its counters are read around each run
+Result measure(const std::string& algorithm, const std::string& family, const Graph& g, double param, int reps, std::function<long long()> f, PerfCounters* perf) {
+	Result r = {algorithm, family, g.n, g.m, param, 1e300, 0, 0, 0, {}};
+	for (int k = 0; k < reps; k++) {
+		reset_peak_memory();
+		if (perf)
+			perf->start();
+		run_nodes = 0;
+		auto start = std::chrono::steady_clock::now();
+		r.answer = f();
+		auto end = std::chrono::steady_clock::now();
+		double time_ms = std::chrono::duration<double, std::milli>(end - start).count();
+		if (perf) {
+			auto counters = perf->stop();
+			if (time_ms < r.time_ms)
+				r.counters = counters;
+		}
+		if (time_ms < r.time_ms)
+			r.nodes = run_nodes;
+		r.time_ms = std::min(r.time_ms, time_ms);
+		r.peak_kb = std::max(r.peak_kb, peak_memory_kb());
+	}
+	return r;
+}
+
+// Algorithms, each one receives the graph the way its tool does
+
+// Returns the CSR lists of g
+CsrGraph lists_of(const Graph& g) {
+	CsrGraph csr;
+	csr.n = g.n;
+	csr.offsets.assign(g.n + 1, 0);
+	for (int i = 0; i < g.n; i++) {
+		for (int j = 0; j < g.n; j++)
+			if (g.has(i, j))
+				csr.neighbors.push_back(j);
+		csr.offsets[i + 1] = csr.neighbors.size();
+	}
+	return csr;
+}
+
+// Loads g into the adjacency matrix of a tool
+template <typename Tool>
+void load_matrix(const Graph& g, Tool set_graph) {
+	CsrGraph csr = lists_of(g);
+	set_graph(g.n, csr.offsets.data(), csr.neighbors.data());
+}
+
+// The solves of the API keep their buffers in it from one run to the next
+SolverContext context;
+
+// bitset_limit as the --bitset option of the tools
+long long run_mis(const Graph& g, int bitset_limit) {
+	SolveOptions options;
+	options.bitset_limit = bitset_limit;
+	SolveResult r = context.independent_set(lists_of(g), options);
+	run_nodes = r.nodes;
+	return r.set.size();
+}
+
+long long run_clique(const Graph& g, int bitset_limit) {
+	SolveOptions options;
+	options.bitset_limit = bitset_limit;
+	SolveResult r = context.clique(lists_of(g), options);
+	run_nodes = r.nodes;
+	return r.set.size();
+}
+
+long long run_fill_in(const Graph& g) {
+	fill::order ord = fill::max_card_search((int*) g.M.data(), g.n);
+	int* H = fill::fill_in((int*) g.M.data(), g.n, ord);
+	long long fill_edges = 0;
+	for (long long k = 0; k < (long long) g.n * g.n; k++)
+		fill_edges += H[k];
+	free(H);
+	free(ord.ord);
+	free(ord.vert);
+	return fill_edges / 2 - g.m;
+}
+
+long long run_zero_fill_in(const Graph& g) {
+	load_matrix(g, chordal::set_graph);
+	std::set<int> X;
+	for (int i = 0; i < g.n; i++)
+		X.insert(i);
+	for (auto& component : chordal::connected_components(X))
+		if (!chordal::zero_fill_in(chordal::max_card_search(component), component))
+			return 0;
+	return 1;
+}
+
+long long run_cart_prod(const Graph& g) {
+	int* P = product::cartProd((int*) g.M.data(), (int*) g.M.data(), g.n, g.n);
+	long long edges = 0;
+	for (long long k = 0; k < (long long) g.n * g.n * g.n * g.n; k++)
+		edges += P[k];
+	free(P);
+	return edges / 2;
+}
+
+long long run_blossom(const Graph& g) {
+	return context.matching(lists_of(g)).edges.size();
+}
+
+// Returns g with its vertices renumbered by method
+Graph relabeled(const Graph& g, const std::string& method) {
+	CsrGraph csr = lists_of(g);
+	Relabeling r;
+	relabel_graph(method, g.n, csr.offsets.data(), csr.neighbors.data(), r);
+	Graph h;
+	h.init(g.n);
+	for (int i = 0; i < g.n; i++)
+		for (uint64_t k = r.graph.offsets[i]; k < r.graph.offsets[i + 1]; k++)
+			h.add(i, r.graph.neighbors[k]);
+	return h;
+}
+
+// Writes the results as a JSON array
+void print_json(std::ostream& out, const std::vector<Result>& results) {
+	out << "[\n";
+	for (size_t k = 0; k < results.size(); k++) {
+		const Result& r = results[k];
+		out << "  {\"algorithm\": \"" << r.algorithm << "\", \"family\": \"" << r.family
+			<< "\", \"n\": " << r.n << ", \"m\": " << r.m << ", \"param\": " << r.param
+			<< ", \"time_ms\": " << r.time_ms
+			<< ", \"nodes\": " << r.nodes
+			<< ", \"nodes_per_sec\": " << (r.time_ms > 0 ? r.nodes / (r.time_ms / 1000) : 0)
+			<< ", \"peak_kb\": " << r.peak_kb << ", \"answer\": " << r.answer;
+		if (!r.counters.empty()) {
+			out << ", \"counters\": {";
+			for (size_t c = 0; c < r.counters.size(); c++)
+				out << (c ? ", \"" : "\"") << r.counters[c].first << "\": " << r.counters[c].second;
+			out << "}";
+		}
+		out << "}" << (k + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+	bool quick = false, use_perf = false;
+	const char* output = NULL;
+	std::string method;
+	for (int k = 1; k < argc; k++) {
+		if (!strcmp(argv[k], "--quick"))
+			quick = true;
+		else if (!strcmp(argv[k], "--perf"))
+			use_perf = true;
+		else if (k + 1 < argc && !strcmp(argv[k], "--relabel"))
+			method = argv[++k];
+		else
+			output = argv[k];
+	}
+	if (!method.empty() && !relabel_known(method)) {
+		std::cerr << "Unknown relabeling " << method << ", use degree, rcm or bfs\n";
+		return 1;
+	}
+	auto prepare = [&](Graph g) {
+		return method.empty() ? g : relabeled(g, method);
+	};
+
+	int reps = quick ? 1 : 3;
+	std::vector<Result> results;
+	std::mt19937 rng(2022);
+
+	PerfCounters* perf = NULL;
+	if (use_perf) {
+		perf = new PerfCounters();
+		if (!perf->available()) {
+			std::cerr << "Hardware counters are not available (see /proc/sys/kernel/perf_event_paranoid), measuring time only\n";
+			delete perf;
+			perf = NULL;
+		}
+	}
+
+	// Each algorithm has its own sizes, the exact searches are exponential
+	// Above bitset_limit the independent set search only takes the denser
+	// G(n,p), the sparse ones are out of its reach there
+	struct Sweep {
+		std::string algorithm;
+		std::function<long long(const Graph&)> run;
+		std::vector<int> sizes;
+		std::vector<double> densities; // Of G(n,p)
+	};
+	auto mis = [](int bitset_limit) {
+		return [bitset_limit](const Graph& g) { return run_mis(g, bitset_limit); };
+	};
+	auto clique = [](int bitset_limit) {
+		return [bitset_limit](const Graph& g) { return run_clique(g, bitset_limit); };
+	};
+	std::vector<int> small = quick ? std::vector<int>{16, 24} : std::vector<int>{16, 32, 48, 64};
+	std::vector<double> densities = {0.1, 0.3, 0.5}, dense = {0.3, 0.5};
+	std::vector<Sweep> sweeps = {
+		{"MIS", mis(128), small, densities},
+		{"MIS", mis(128), quick ? std::vector<int>{160} : std::vector<int>{160, 192}, dense},
+		{"MIS --bitset 1", mis(1), small, densities},
+		{"clique", clique(128), small, densities},
+		{"clique", clique(128), quick ? std::vector<int>{160} : std::vector<int>{160, 256}, densities},
+		{"clique --bitset 1", clique(1), small, densities},
+		{"max_card_search+fill_in", run_fill_in, quick ? std::vector<int>{64, 128} : std::vector<int>{128, 256, 512, 1024}, densities},
+		{"zero_fill_in", run_zero_fill_in, quick ? std::vector<int>{32, 64} : std::vector<int>{64, 128, 256, 512}, densities},
+		{"cartProd", run_cart_prod, quick ? std::vector<int>{8, 12} : std::vector<int>{8, 16, 24, 32}, densities},
+		{"Blossom", run_blossom, quick ? std::vector<int>{64, 128} : std::vector<int>{256, 512, 1024, 2048}, densities},
+	};
+
+	for (auto& s : sweeps) {
+		for (int n : s.sizes) {
+			for (double p : s.densities) {
+				Graph g = prepare(gnp(n, p, rng));
+				results.push_back(measure(s.algorithm, "gnp", g, p, reps, [&]() { return s.run(g); }, perf));
+			}
+
+			Graph c = prepare(random_chordal(n, rng));
+			results.push_back(measure(s.algorithm, "chordal", c, 0, reps, [&]() { return s.run(c); }, perf));
+
+			int side = std::max(2, (int) std::sqrt((double) n));
+			Graph r = prepare(grid(side, (n + side - 1) / side));
+			results.push_back(measure(s.algorithm, "grid", r, side, reps, [&]() { return s.run(r); }, perf));
+
+			Graph w = prepare(power_law(n, 2, rng));
+			results.push_back(measure(s.algorithm, "power_law", w, 2, reps, [&]() { return s.run(w); }, perf));
+
+			std::cerr << s.algorithm << " n = " << n << " done\n";
+		}
+	}
+
+	if (output) {
+		std::ofstream out(output);
+		print_json(out, results);
+	}
+	else
+		print_json(std::cout, results);
+
+	delete perf;
+
+	return 0;
+}
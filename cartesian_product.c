@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "graph_csr.h"
+
 // Print the adjacency matrix M with V vertices
 void printAdjMat (int * M, int V){
 	int i, j;
@@ -28,7 +30,7 @@ int* cartProd (int* G, int *H, int VG, int VH){
 	
 	// P is a VP x VP adj. matrix with aij = (vi, uj) as its vertexes, a pair of vi in G and uj in H
 	// Each element elc in P is a (a l/VH l%VH, a c/VG c%VG) edge
-	P = calloc (VP*VP, sizeof(int));
+	P = (int*) calloc (VP*VP, sizeof(int));
 	if (!P) return NULL;
 	
 	// For each edge (vi, vj) in G, make (aim, ajm) for m from 0 to VH:
@@ -60,11 +62,53 @@ int* cartProd (int* G, int *H, int VG, int VH){
 	return P;
 }
 
-int main(){
+// Computes G x H of the binary CSR files in paths g_path and h_path
+// Writes the product in p_path or prints it if p_path is NULL
+int cartProdFiles (const char* g_path, const char* h_path, const char* p_path){
+	csr_graph g, h;
+	int *G, *H, *P;
+	int VG, VH, r = 0;
+	
+	if (csr_open (g_path, &g)) return 1;
+	if (csr_open (h_path, &h)){
+		csr_close (&g);
+		return 1;
+	}
+	
+	VG = g.n;
+	VH = h.n;
+	G = csr_to_matrix (&g);
+	H = csr_to_matrix (&h);
+	csr_close (&g);
+	csr_close (&h);
+	
+	P = (G && H) ? cartProd (G, H, VG, VH) : NULL;
+	if (!P) r = 1;
+	else if (p_path) r = csr_write_matrix (p_path, P, VG*VH) ? 1 : 0;
+	else printAdjMat (P, VG*VH);
+	
+	free (G);
+	free (H);
+	free (P);
+	return r;
+}
+
+#ifndef NO_MAIN
+// With "G.csr H.csr [P.csr]" as arguments computes the product of
+// two binary CSR files, otherwise computes the example
+int main(int argc, char* argv[]){
 	int VH = 3, VG = 3;
 	int G[3][3] = {{0,1,1},{1,0,1},{1,1,0}}, H[3][3] = {{0,1,0},{1,0,1},{0,1,0}};
 	int *P;
 	
+	if (argc >= 3){
+		if (cartProdFiles (argv[1], argv[2], argc >= 4 ? argv[3] : NULL)){
+			printf("Could not compute the product of %s and %s\n", argv[1], argv[2]);
+			return 1;
+		}
+		return 0;
+	}
+	
 	printf("G:\n");
 	printAdjMat (G, VG);
 	
@@ -79,3 +123,4 @@ int main(){
 	free (P);
 	return 0;
 }
+#endif
@@ -4,6 +4,11 @@
 #include <map>
 #include <algorithm>
 
+#include "graph_csr.h"
+#include "graph_formats.h"
+#include "graph_relabel.h"
+#include "graph_compressed.h"
+
 // Structures
 
 // ord(i) has the number of vertex i in the ordenation
@@ -15,19 +20,33 @@ typedef struct order_alpha {
 
 
 //Global variables
-int mat[100][100];
+std::vector<std::vector<bool>> mat; // Adjacency matrix
 
 int N_vertices;
 
+std::string relabel_method; // Relabeling of the input, empty for none
+
+// With use_compressed the graph is kept as compressed lists
+// (see graph_compressed.h) instead of the matrix
+bool use_compressed = false;
+CompressedGraph compressed;
+
 
 // Declarations
 bool edge(int i, int j);
+void set_graph(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors);
+bool load_csr(const char* path);
+bool load_format(const char* format, const char* path);
 bool cmp_second(std::pair<int, int> a, std::pair<int, int> b);
 int find(std::vector<int>& parent, int i);
 void unite(std::vector<int>& parent, int x, int y);
 std::vector<std::set<int>> connected_components(std::set<int> vertices);
 order max_card_search(std::set<int> X_set);
 bool zero_fill_in(order ord, std::set<int> X_set);
+template <typename Graph>
+std::vector<uint32_t> mcs_order(const Graph& g);
+template <typename Graph>
+bool is_chordal(const Graph& g);
 
 //Definitions
 
@@ -37,6 +56,55 @@ bool edge(int i, int j) {
 	return mat[i][j];
 }
 
+// Fills the adjacency matrix with the lists of a CSR graph with n vertices,
+// relabeled first if relabel_method is set (see graph_relabel.h),
+// or compresses the lists with use_compressed
+void set_graph(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors) {
+	Relabeling r;
+	if (!relabel_method.empty() && relabel_graph(relabel_method, n, offsets, neighbors, r)) {
+		offsets = r.graph.offsets.data();
+		neighbors = r.graph.neighbors.data();
+	}
+
+	if (use_compressed) {
+		N_vertices = n;
+		compressed.build(n, offsets, neighbors);
+		compressed.report();
+		return;
+	}
+
+	N_vertices = n;
+	mat.assign(N_vertices, std::vector<bool>(N_vertices));
+	for (int v = 0; v < N_vertices; v++)
+		for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++)
+			mat[v][neighbors[k]] = true;
+}
+
+// Loads the graph of a binary CSR file (see graph_csr.h)
+// into the adjacency matrix, without parsing text
+// Returns false if the file can't be loaded
+bool load_csr(const char* path) {
+	csr_graph g;
+	if (csr_open(path, &g))
+		return false;
+
+	set_graph(g.n, g.offsets, g.neighbors);
+
+	csr_close(&g);
+	return true;
+}
+
+// Loads the graph of a file in one of the formats of graph_formats.h
+// Returns false if the file can't be loaded
+bool load_format(const char* format, const char* path) {
+	CsrGraph g;
+	if (!read_graph_file(format, path, g))
+		return false;
+
+	set_graph(g.n, g.offsets.data(), g.neighbors.data());
+	return true;
+}
+
 // Function to sort a vector of pairs by the second value
 bool cmp_second(std::pair<int, int> a, std::pair<int, int> b) {
 	return a.second < b.second;
@@ -218,16 +286,155 @@ bool zero_fill_in(order ord, std::set<int> X_set) {
 	return true;
 }
 
-// Input the number of vertices and adjacency matrix
+// Orders the vertices of g by maximum cardinality search in O(n + m)
+// with a list of the unnumbered vertices of each count of numbered neighbors
+// Returns the vertex of each number, the first one picked gets n - 1
+// Graph is CompressedGraph or CsrView, see graph_compressed.h
+template <typename Graph>
+std::vector<uint32_t> mcs_order(const Graph& g) {
+	uint32_t n = g.n;
+	std::vector<uint32_t> vert(n);
+	std::vector<int> count(n, 0); // Numbered neighbors, -1 once numbered
+	std::vector<int> head(n + 1, -1), next(n), prev(n);
+
+	auto unlink = [&](uint32_t v) {
+		if (prev[v] >= 0)
+			next[prev[v]] = next[v];
+		else
+			head[count[v]] = next[v];
+		if (next[v] >= 0)
+			prev[next[v]] = prev[v];
+	};
+	auto link = [&](uint32_t v) {
+		prev[v] = -1;
+		next[v] = head[count[v]];
+		if (next[v] >= 0)
+			prev[next[v]] = v;
+		head[count[v]] = v;
+	};
+
+	for (uint32_t v = n; v-- > 0; )
+		link(v);
+
+	int j = 0;
+	for (uint32_t i = n; i-- > 0; ) {
+		while (head[j] < 0)
+			j--;
+		uint32_t v = head[j];
+		unlink(v);
+		count[v] = -1;
+		vert[i] = v;
+
+		g.for_each_neighbor(v, [&](uint32_t w) {
+			if (count[w] >= 0 && w != v) {
+				unlink(w);
+				count[w]++;
+				link(w);
+			}
+		});
+		j++;
+	}
+
+	return vert;
+}
+
+// Checks in O(n + m) if the order of maximum cardinality search is a
+// perfect elimination order (Tarjan and Yannakakis), the same test as
+// zero_fill_in with the follower of each vertex
+// Returns true if g is chordal
+template <typename Graph>
+bool is_chordal(const Graph& g) {
+	uint32_t n = g.n;
+	std::vector<uint32_t> vert = mcs_order(g);
+	std::vector<uint32_t> number(n), f(n), index(n);
+	for (uint32_t i = 0; i < n; i++)
+		number[vert[i]] = i;
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t w = vert[i];
+		f[w] = w;
+		index[w] = i;
+		g.for_each_neighbor(w, [&](uint32_t v) {
+			if (number[v] < i) {
+				index[v] = i;
+				if (f[v] == v)
+					f[v] = w;
+			}
+		});
+
+		// Every neighbor numbered before w must have w or a neighbor
+		// of w as its follower
+		bool chordal = true;
+		g.for_each_neighbor(w, [&](uint32_t v) {
+			if (number[v] < i && index[f[v]] < i)
+				chordal = false;
+		});
+		if (!chordal)
+			return false;
+	}
+
+	return true;
+}
+
+#ifndef NO_MAIN
+// Input the number of vertices and adjacency matrix,
+// or the path of a binary CSR file as argument,
+// or "--dimacs", "--metis", "--mtx" or "--snap" and the path of a file
 // The graph must be connected
+// "--relabel degree|rcm|bfs" renumbers the vertices first
+// "--compressed" keeps the graph as compressed lists and tests it in
+// linear time, for graphs too big for the matrix, connected or not
 // Prints if graph is chordal or not
-int main() {
+int main(int argc, char* argv[]) {
+	argc = relabel_options(argc, argv, relabel_method);
+	if (!relabel_method.empty() && !relabel_known(relabel_method)) {
+		std::cout << "Unknown relabeling " << relabel_method << ", use degree, rcm or bfs\n";
+		return 1;
+	}
+	int left = 1;
+	for (int k = 1; k < argc; k++) {
+		if (std::string(argv[k]) == "--compressed")
+			use_compressed = true;
+		else
+			argv[left++] = argv[k];
+	}
+	argc = left;
 
-	std::cin >> N_vertices;
+	if (argc >= 3 && argv[1][0] == '-') {
+		if (!load_format(argv[1] + 2, argv[2])) {
+			std::cout << "Could not load " << argv[2] << "\n";
+			return 1;
+		}
+	}
+	else if (argc >= 2) {
+		if (!load_csr(argv[1])) {
+			std::cout << "Could not load " << argv[1] << "\n";
+			return 1;
+		}
+	}
+	else {
+		uint64_t n;
+		std::cin >> n;
+
+		// The matrix goes through the lists, so it can be relabeled
+		std::vector<uint64_t> offsets(n + 1, 0);
+		std::vector<uint32_t> neighbors;
+		for (uint64_t i = 0; i < n; i++) {
+			for (uint64_t j = 0; j < n; j++) {
+				int a;
+				std::cin >> a;
+				if (a)
+					neighbors.push_back(j);
+			}
+			offsets[i + 1] = neighbors.size();
+		}
+		set_graph(n, offsets.data(), neighbors.data());
+	}
 
-	for (int i = 0; i < N_vertices; i++)
-		for (int j = 0; j < N_vertices; j++)
-			std::cin >> mat[i][j];
+	if (use_compressed) {
+		std::cout << (is_chordal(compressed) ? "The graph is chordal\n" : "The graph is not chordal\n");
+		return 0;
+	}
 
 	std::set<int> X;
 	for (int i = 0; i < N_vertices; i++)
@@ -247,3 +454,4 @@ int main() {
 
 	return 0;
 }
+#endif
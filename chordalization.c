@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "graph_csr.h"
+
 // Print the adjacency matrix M with V vertices
 void printAdjMat (int * M, int V){
 	int i, j;
@@ -65,16 +67,16 @@ order max_card_search (int* G, int V){
 	// Each column is a vertex
 	// set(i,j) = 1 if vertex j is in set i
 	// set(i,j) = 0 if it is not
-	set = calloc (V*V, sizeof(int));
+	set = (int*) calloc (V*V, sizeof(int));
 	if (!set) return ord;
 	
 	// size(i) is the number of numbered neighbors to vertex i
-	size = calloc (V, sizeof(int));
+	size = (int*) calloc (V, sizeof(int));
 	if (!size) return ord;
 	
 	// ord has the ordenation
-	ord.ord = calloc (V, sizeof(int));
-	ord.vert = calloc (V, sizeof(int));
+	ord.ord = (int*) calloc (V, sizeof(int));
+	ord.vert = (int*) calloc (V, sizeof(int));
 	
 	// All vertices have 0 numbered neighbors in the beginning
 	for (i=0; i < V; i++)
@@ -128,16 +130,16 @@ int* fill_in(int* G, int V, order ord){
 	
 	// f(v) is the follower of v, i.e. the neighbor of v
 	// with the smallest ordering that is bigger than v's
-	f = calloc(V, sizeof(int));
+	f = (int*) calloc(V, sizeof(int));
 	if (!f) return NULL;
 	
 	// index(v) is the biggest vertex between v and
 	// v's already processed neighbors 
-	index = calloc(V, sizeof(int));
+	index = (int*) calloc(V, sizeof(int));
 	if (!index) return NULL;
 	
 	// The adjacency matrix which will receive the fill in
-	H  = calloc (V*V, sizeof(int));
+	H  = (int*) calloc (V*V, sizeof(int));
 	if (!H) return NULL;
 	
 	// H receives a copy of G
@@ -187,11 +189,53 @@ int* fill_in(int* G, int V, order ord){
 
 
 
-int main(){
+// Computes the fill in of the binary CSR file in g_path
+// Writes the chordal graph in h_path or prints it if h_path is NULL
+int fillInFile (const char* g_path, const char* h_path){
+	csr_graph g;
+	int *G, *H;
+	int V, r = 0;
+	order ord;
+	
+	if (csr_open (g_path, &g)) return 1;
+	V = g.n;
+	G = csr_to_matrix (&g);
+	csr_close (&g);
+	if (!G) return 1;
+	
+	ord = max_card_search (G, V);
+	H = fill_in(G, V, ord);
+	
+	if (!H) r = 1;
+	else if (h_path) r = csr_write_matrix (h_path, H, V) ? 1 : 0;
+	else {
+		printf("After fill in:\n");
+		printAdjMat (H, V);
+	}
+	
+	free(ord.ord);
+	free(ord.vert);
+	free(G);
+	free(H);
+	return r;
+}
+
+#ifndef NO_MAIN
+// With "G.csr [H.csr]" as arguments computes the fill in
+// of a binary CSR file, otherwise computes the example
+int main(int argc, char* argv[]){
 	int *G, *H;
 	int V = 9, i;
 	order ord;
 	
+	if (argc >= 2){
+		if (fillInFile (argv[1], argc >= 3 ? argv[2] : NULL)){
+			printf("Could not compute the fill in of %s\n", argv[1]);
+			return 1;
+		}
+		return 0;
+	}
+	
 	int ex[9][9] = 	{{0,0,1,1,0,0,0,0,0},
 					{0,0,1,0,0,0,1,0,0},
 					{1,1,0,0,1,1,0,0,0},
@@ -230,3 +274,4 @@ int main(){
 	free(H);
 	return 0;
 }
+#endif
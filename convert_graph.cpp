@@ -0,0 +1,117 @@
+#include <iostream>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+#include "graph_csr.h"
+#include "graph_formats.h"
+
+// Reads unsigned integers from a file with a big buffer
+// instead of formatted reads
+class IntReader {
+	FILE* file;
+	std::vector<char> buffer;
+	size_t pos, len;
+
+	// Returns the next character or EOF
+	int next_char() {
+		if (pos == len) {
+			len = fread(buffer.data(), 1, buffer.size(), file);
+			pos = 0;
+			if (len == 0)
+				return EOF;
+		}
+		return buffer[pos++];
+	}
+
+public:
+	IntReader(FILE* file) : file(file), buffer(1 << 20), pos(0), len(0) {}
+
+	// Reads the next integer into x
+	// Returns false at the end of the file
+	bool next(uint64_t& x) {
+		int c = next_char();
+		while (c != EOF && (c < '0' || c > '9'))
+			c = next_char();
+		if (c == EOF)
+			return false;
+
+		x = 0;
+		while (c >= '0' && c <= '9') {
+			x = x * 10 + (c - '0');
+			c = next_char();
+		}
+		return true;
+	}
+};
+
+// Converts a file in one of the formats of graph_formats.h to a CSR file
+int convert_format(const char* format, const char* input, const char* output) {
+	CsrGraph g;
+	if (!read_graph_file(format, input, g)) {
+		std::cerr << "Could not read " << input << " as " << format << "\n";
+		return 1;
+	}
+
+	if (csr_write(output, g.n, g.neighbors.size(), g.offsets.data(), g.neighbors.data())) {
+		std::cerr << "Could not write " << output << "\n";
+		return 1;
+	}
+
+	std::cout << g.n << " vertices and " << g.neighbors.size() / 2 << " edges written to " << output << "\n";
+
+	return 0;
+}
+
+// Input the number of vertices and adjacency matrix, or
+// "--dimacs", "--metis", "--mtx" or "--snap" and an input file
+// Writes the graph as a binary CSR file, see graph_csr.h
+int main(int argc, char* argv[]) {
+	if (argc >= 4 && argv[1][0] == '-')
+		return convert_format(argv[1] + 2, argv[2], argv[3]);
+
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " output.csr < matrix.txt\n";
+		std::cerr << "       " << argv[0] << " --dimacs|--metis|--mtx|--snap input output.csr\n";
+		return 1;
+	}
+
+	IntReader in(stdin);
+	uint64_t N_vertices, a;
+	if (!in.next(N_vertices)) {
+		std::cerr << "Missing number of vertices\n";
+		return 1;
+	}
+
+	// Rows are read in order, so the neighbors come out sorted
+	std::vector<uint64_t> offsets(N_vertices + 1, 0);
+	std::vector<uint32_t> neighbors;
+	for (uint64_t i = 0; i < N_vertices; i++) {
+		offsets[i] = neighbors.size();
+		for (uint64_t j = 0; j < N_vertices; j++) {
+			if (!in.next(a)) {
+				std::cerr << "The matrix ends before " << N_vertices << " rows\n";
+				return 1;
+			}
+			if (a)
+				neighbors.push_back(j);
+		}
+	}
+	offsets[N_vertices] = neighbors.size();
+
+	// csr_open rejects files that break the format, so check before writing
+	csr_graph view = {N_vertices, neighbors.size(), offsets.data(), neighbors.data(), NULL, 0};
+	if (N_vertices > UINT32_MAX || !csr_valid(&view)) {
+		std::cerr << "The matrix is not symmetric or has loops\n";
+		return 1;
+	}
+
+	if (csr_write(argv[1], N_vertices, neighbors.size(), offsets.data(), neighbors.data())) {
+		std::cerr << "Could not write " << argv[1] << "\n";
+		return 1;
+	}
+
+	std::cout << N_vertices << " vertices and " << neighbors.size() / 2 << " edges written to " << argv[1] << "\n";
+
+	return 0;
+}
@@ -0,0 +1,212 @@
+#ifndef GRAPH_COMPONENTS_H
+#define GRAPH_COMPONENTS_H
+
+// Parallel connected components and degree statistics of CSR graphs
+//
+// Components are labeled with Afforest (Sutton, Ben-Nun and Barak): each
+// vertex starts as a tree of its own, and an edge links two trees by
+// pointing the bigger root to the smaller one with a compare and swap, as
+// in Shiloach-Vishkin, so the threads take no locks. The first rounds link
+// only the first NEIGHBOR_ROUNDS neighbors of each vertex, which in most
+// graphs already joins the biggest component. Its root is found by
+// sampling vertices, and the rest of the edges are followed only from the
+// vertices out of it, so most of its edges are never read
+// The lists must be symmetric, as the ones of graph_formats.h are
+//
+// The work is split in chunks of vertices that the threads take in turn
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define NEIGHBOR_ROUNDS 2 // Neighbors of each vertex linked before sampling
+#define COMPONENT_SAMPLES 1024 // Vertices sampled for the biggest component
+#define CHUNK_VERTICES 4096 // Vertices of each chunk of the threads
+
+// Calls f(begin, end, thread) for chunks of [0, n) in threads threads
+template <typename F>
+void parallel_chunks(uint64_t n, int threads, F f) {
+	if (n < CHUNK_VERTICES)
+		threads = 1;
+	std::atomic<uint64_t> next(0);
+	auto worker = [&](int t) {
+		for (uint64_t begin = next.fetch_add(CHUNK_VERTICES); begin < n; begin = next.fetch_add(CHUNK_VERTICES))
+			f(begin, std::min(n, begin + CHUNK_VERTICES), t);
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads; t++)
+		pool.emplace_back(worker, t);
+	worker(0);
+	for (auto& th : pool)
+		th.join();
+}
+
+inline uint32_t load_parent(const uint32_t* comp, uint32_t v) {
+	return __atomic_load_n(&comp[v], __ATOMIC_RELAXED);
+}
+
+// Joins the trees of u and v
+inline void link_trees(uint32_t u, uint32_t v, uint32_t* comp) {
+	uint32_t p1 = load_parent(comp, u), p2 = load_parent(comp, v);
+	while (p1 != p2) {
+		uint32_t high = std::max(p1, p2), low = std::min(p1, p2);
+		uint32_t p_high = load_parent(comp, high);
+		if (p_high == low) // Another thread linked them
+			break;
+		if (p_high == high && __atomic_compare_exchange_n(&comp[high], &p_high, low, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			break;
+		// high got a parent in the meantime, so both go up
+		p1 = load_parent(comp, load_parent(comp, high));
+		p2 = load_parent(comp, low);
+	}
+}
+
+// Points every vertex straight to its root
+inline void compress_trees(uint64_t n, uint32_t* comp, int threads) {
+	parallel_chunks(n, threads, [&](uint64_t begin, uint64_t end, int) {
+		for (uint64_t v = begin; v < end; v++)
+			while (load_parent(comp, v) != load_parent(comp, load_parent(comp, v)))
+				__atomic_store_n(&comp[v], load_parent(comp, load_parent(comp, v)), __ATOMIC_RELAXED);
+	});
+}
+
+// Labels each vertex of the CSR graph with n vertices with the smallest
+// vertex of its component, in comp
+// Returns the label of the component the sample found the biggest
+inline uint32_t afforest(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors, int threads, std::vector<uint32_t>& comp) {
+	comp.resize(n);
+	for (uint64_t v = 0; v < n; v++)
+		comp[v] = v;
+	if (n == 0)
+		return 0;
+
+	for (int r = 0; r < NEIGHBOR_ROUNDS; r++) {
+		parallel_chunks(n, threads, [&](uint64_t begin, uint64_t end, int) {
+			for (uint64_t v = begin; v < end; v++)
+				if (offsets[v] + r < offsets[v + 1])
+					link_trees(v, neighbors[offsets[v] + r], comp.data());
+		});
+		compress_trees(n, comp.data(), threads);
+	}
+
+	// The most frequent root of the sample
+	std::mt19937_64 rng(2022);
+	std::unordered_map<uint32_t, int> count;
+	uint32_t giant = comp[0];
+	for (int k = 0; k < COMPONENT_SAMPLES; k++) {
+		uint32_t root = comp[rng() % n];
+		if (++count[root] > count[giant])
+			giant = root;
+	}
+
+	// Edges of the giant component to others are linked from the other end
+	parallel_chunks(n, threads, [&](uint64_t begin, uint64_t end, int) {
+		for (uint64_t v = begin; v < end; v++) {
+			if (load_parent(comp.data(), v) == giant)
+				continue;
+			for (uint64_t k = offsets[v] + NEIGHBOR_ROUNDS; k < offsets[v + 1]; k++)
+				link_trees(v, neighbors[k], comp.data());
+		}
+	});
+	compress_trees(n, comp.data(), threads);
+
+	return comp[giant];
+}
+
+// Components of a graph, numbered by decreasing size
+struct Components {
+	std::vector<uint32_t> label; // Component of each vertex
+	std::vector<uint64_t> sizes; // Vertices of each component
+};
+
+// Finds the components of the CSR graph with n vertices into c
+inline void label_components(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors, int threads, Components& c) {
+	std::vector<uint32_t>& comp = c.label;
+	uint32_t giant = afforest(n, offsets, neighbors, threads, comp);
+
+	// The vertices of the biggest component, most of them in many graphs,
+	// are counted by each thread and added once, so they don't fight over
+	// one counter
+	std::vector<uint32_t> size(n, 0);
+	parallel_chunks(n, threads, [&](uint64_t begin, uint64_t end, int) {
+		uint32_t in_giant = 0;
+		for (uint64_t v = begin; v < end; v++) {
+			if (comp[v] == giant)
+				in_giant++;
+			else
+				__atomic_fetch_add(&size[comp[v]], 1, __ATOMIC_RELAXED);
+		}
+		__atomic_fetch_add(&size[giant], in_giant, __ATOMIC_RELAXED);
+	});
+
+	// Roots by decreasing size, and then by vertex
+	std::vector<uint32_t> roots;
+	for (uint64_t v = 0; v < n; v++)
+		if (size[v])
+			roots.push_back(v);
+	std::stable_sort(roots.begin(), roots.end(), [&](uint32_t a, uint32_t b) {
+		return size[a] > size[b];
+	});
+
+	c.sizes.resize(roots.size());
+	std::vector<uint32_t> number(n);
+	for (size_t k = 0; k < roots.size(); k++) {
+		c.sizes[k] = size[roots[k]];
+		number[roots[k]] = k;
+	}
+	parallel_chunks(n, threads, [&](uint64_t begin, uint64_t end, int) {
+		for (uint64_t v = begin; v < end; v++)
+			comp[v] = number[comp[v]];
+	});
+}
+
+// Degrees of a graph, with a histogram by powers of two
+struct DegreeStats {
+	uint64_t min = 0, max = 0, sum = 0;
+	std::vector<uint64_t> buckets; // buckets[0] has degree 0, buckets[k] degrees in [2^(k - 1), 2^k)
+};
+
+// Bucket of the degree d in DegreeStats
+inline int degree_bucket(uint64_t d) {
+	return d ? 64 - __builtin_clzll(d) : 0;
+}
+
+// Counts the degrees of the CSR graph with n vertices, each thread
+// in its own histogram, added up at the end
+inline DegreeStats degree_stats(uint64_t n, const uint64_t* offsets, int threads) {
+	std::vector<DegreeStats> parts(std::max(threads, 1));
+	for (auto& p : parts) {
+		p.min = UINT64_MAX;
+		p.buckets.assign(65, 0);
+	}
+	parallel_chunks(n, threads, [&](uint64_t begin, uint64_t end, int t) {
+		DegreeStats& p = parts[t];
+		for (uint64_t v = begin; v < end; v++) {
+			uint64_t d = offsets[v + 1] - offsets[v];
+			p.min = std::min(p.min, d);
+			p.max = std::max(p.max, d);
+			p.sum += d;
+			p.buckets[degree_bucket(d)]++;
+		}
+	});
+
+	DegreeStats s = parts[0];
+	for (size_t t = 1; t < parts.size(); t++) {
+		s.min = std::min(s.min, parts[t].min);
+		s.max = std::max(s.max, parts[t].max);
+		s.sum += parts[t].sum;
+		for (int k = 0; k < 65; k++)
+			s.buckets[k] += parts[t].buckets[k];
+	}
+	if (n == 0)
+		s.min = 0;
+	s.buckets.resize(degree_bucket(s.max) + 1);
+	return s;
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef GRAPH_COMPRESSED_H
+#define GRAPH_COMPRESSED_H
+
+// Compressed adjacency lists, for graphs too big for a CSR in memory
+//
+// The list of v is its degree, then its first neighbor as a signed
+// distance to v, then the gaps minus one between consecutive neighbors,
+// all as varints (7 bits per byte, the high bit set on every byte but
+// the last). Sorted lists of graphs with some locality (see
+// graph_relabel.h) have gaps of one byte, so a neighbor takes one or two
+// bytes instead of four. The lists of each group of 64 vertices start at a
+// 64 bits position, and each list at a 32 bits distance from it
+//
+// The lists are decoded in blocks of COMPRESSED_BLOCK neighbors into
+// a buffer on the stack. Eight one-byte gaps are recognized with one
+// test of a word, so the common case decodes eight neighbors at a time
+//
+// CompressedGraph and CsrView have the same interface, n, degree(v) and
+// for_each_neighbor(v, f), so the algorithms written for it take both
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#define COMPRESSED_BLOCK 64 // Neighbors decoded at a time
+
+// Position in the list of a vertex, to decode it block by block
+struct ListCursor {
+	const uint8_t* p; // Next byte
+	uint32_t vertex;
+	uint32_t left; // Neighbors not decoded yet
+	uint32_t last; // Last neighbor decoded
+	bool first; // No neighbor decoded yet
+};
+
+class CompressedGraph {
+	std::vector<uint64_t> group_start; // Position in data of each group of 64 vertices
+	std::vector<uint32_t> start; // Position of the list of each vertex in its group
+	std::vector<uint8_t> data;
+
+	void put_varint(uint64_t x) {
+		while (x >= 0x80) {
+			data.push_back(x | 0x80);
+			x >>= 7;
+		}
+		data.push_back(x);
+	}
+
+	static uint64_t get_varint(const uint8_t*& p) {
+		uint64_t x = 0;
+		for (int shift = 0; ; shift += 7) {
+			uint8_t b = *p++;
+			x |= (uint64_t) (b & 0x7f) << shift;
+			if (!(b & 0x80))
+				return x;
+		}
+	}
+
+public:
+	uint64_t n = 0;
+
+	// Compresses the CSR graph with n vertices
+	// The lists must be sorted with no repeated neighbors
+	void build(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors) {
+		this->n = n;
+		group_start.resize(n / 64 + 1);
+		start.resize(n);
+		data.clear();
+		data.reserve(offsets[n] + 2 * n);
+		for (uint64_t v = 0; v < n; v++) {
+			if (v % 64 == 0)
+				group_start[v / 64] = data.size();
+			start[v] = data.size() - group_start[v / 64];
+			put_varint(offsets[v + 1] - offsets[v]);
+			for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++) {
+				if (k == offsets[v]) {
+					int64_t d = (int64_t) neighbors[k] - (int64_t) v;
+					put_varint(d < 0 ? -2 * d - 1 : 2 * d); // Zigzag, small either way
+				}
+				else
+					put_varint(neighbors[k] - neighbors[k - 1] - 1);
+			}
+		}
+
+		// The fast path of next_block reads a whole word
+		data.resize(data.size() + 8, 0);
+		data.shrink_to_fit();
+	}
+
+	// Bytes of the lists and their positions
+	uint64_t bytes() const {
+		return data.size() + group_start.size() * sizeof(uint64_t) + start.size() * sizeof(uint32_t);
+	}
+
+	ListCursor cursor(uint32_t v) const {
+		ListCursor c;
+		c.p = data.data() + group_start[v / 64] + start[v];
+		c.vertex = v;
+		c.left = get_varint(c.p);
+		c.last = v;
+		c.first = true;
+		return c;
+	}
+
+	uint32_t degree(uint32_t v) const {
+		return cursor(v).left;
+	}
+
+	// Decodes the next neighbors of c, at most COMPRESSED_BLOCK, into out
+	// Returns how many it decoded, 0 at the end of the list
+	uint32_t next_block(ListCursor& c, uint32_t out[]) const {
+		uint32_t count = std::min<uint32_t>(c.left, COMPRESSED_BLOCK), k = 0;
+		if (count && c.first) {
+			uint64_t z = get_varint(c.p);
+			c.last = (int64_t) c.vertex + (z & 1 ? -(int64_t) (z >> 1) - 1 : (int64_t) (z >> 1));
+			out[k++] = c.last;
+			c.first = false;
+		}
+
+		while (k < count) {
+			uint64_t word;
+			memcpy(&word, c.p, 8);
+			if (count - k >= 8 && !(word & 0x8080808080808080ULL)) {
+				for (int b = 0; b < 8; b++)
+					out[k++] = c.last += c.p[b] + 1;
+				c.p += 8;
+			}
+			else
+				out[k++] = c.last += get_varint(c.p) + 1;
+		}
+
+		c.left -= count;
+		return count;
+	}
+
+	template <typename F>
+	void for_each_neighbor(uint32_t v, F f) const {
+		uint32_t buffer[COMPRESSED_BLOCK];
+		ListCursor c = cursor(v);
+		for (uint32_t count; (count = next_block(c, buffer)); )
+			for (uint32_t k = 0; k < count; k++)
+				f(buffer[k]);
+	}
+
+	// Prints to stderr the size against the CSR of the same graph
+	// and the speed of decoding every list once
+	void report() const {
+		auto begin = std::chrono::steady_clock::now();
+		uint64_t m = 0, check = 0;
+		uint32_t buffer[COMPRESSED_BLOCK];
+		for (uint64_t v = 0; v < n; v++) {
+			ListCursor c = cursor(v);
+			for (uint32_t count; (count = next_block(c, buffer)); m += count)
+				check += buffer[count - 1];
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		volatile uint64_t sink = check; // So the decoding is not optimized away
+		(void) sink;
+
+		double csr = (n + 1) * sizeof(uint64_t) + m * sizeof(uint32_t);
+		std::cerr << "Compressed adjacency: " << bytes() / 1e6 << " MB instead of " << csr / 1e6
+			<< " MB of CSR (" << csr / bytes() << "x), decoded " << m << " neighbors in " << ms << " ms ("
+			<< (ms > 0 ? m / ms / 1e3 : 0) << " M/s)\n";
+	}
+};
+
+// A CSR graph with the interface of CompressedGraph
+struct CsrView {
+	uint64_t n;
+	const uint64_t* offsets;
+	const uint32_t* neighbors;
+
+	uint32_t degree(uint32_t v) const {
+		return offsets[v + 1] - offsets[v];
+	}
+
+	template <typename F>
+	void for_each_neighbor(uint32_t v, F f) const {
+		for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++)
+			f(neighbors[k]);
+	}
+};
+
+#endif
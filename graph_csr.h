@@ -0,0 +1,242 @@
+#ifndef GRAPH_CSR_H
+#define GRAPH_CSR_H
+
+// Binary CSR (compressed sparse row) graph format shared by all tools
+// Works in C and in C++
+//
+// File layout:
+// header (32 bytes): magic "GRAPHCSR", version, reserved, n, m
+// offsets: n + 1 unsigned 64 bits integers
+// neighbors: m unsigned 32 bits integers
+//
+// The neighbors of v are neighbors[offsets[v]] to neighbors[offsets[v+1] - 1],
+// sorted, and each edge {u, v} appears in both lists, so m = 2|E|
+// The file is loaded with mmap, so no parsing happens at startup, only a
+// linear pass that checks this layout, see csr_valid
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define CSR_MAGIC "GRAPHCSR"
+#define CSR_VERSION 1
+
+typedef struct csr_header_s {
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	uint64_t n; // Number of vertices
+	uint64_t m; // Number of entries in neighbors
+} csr_header;
+
+typedef struct csr_graph_s {
+	uint64_t n, m;
+	const uint64_t* offsets;
+	const uint32_t* neighbors;
+	void* map; // Start of the mapped file
+	size_t map_size;
+} csr_graph;
+
+// Returns 1 if the offsets of g start at 0, never decrease and end at m,
+// every list is strictly increasing, so it has no duplicates, has no loop
+// and only holds vertices, and every edge appears in both lists
+// Returns 0 otherwise, or if there is no memory
+// Takes O(n + m) time: cur[u] walks the neighbors of u above u, which
+// must be met in order as the lists of the larger vertices are read
+static inline int csr_valid (const csr_graph* g){
+	uint64_t v, k, u;
+	uint64_t* cur;
+	int ok = 1;
+
+	if (g->offsets[0] != 0 || g->offsets[g->n] != g->m) return 0;
+	for (v = 0; v < g->n; v++)
+		if (g->offsets[v] > g->offsets[v + 1]) return 0;
+	for (v = 0; v < g->n; v++)
+		for (k = g->offsets[v]; k < g->offsets[v + 1]; k++)
+			if (g->neighbors[k] >= g->n || g->neighbors[k] == v ||
+				(k > g->offsets[v] && g->neighbors[k] <= g->neighbors[k - 1])) return 0;
+
+	cur = (uint64_t*) malloc ((g->n ? g->n : 1) * sizeof(uint64_t));
+	if (!cur) return 0;
+
+	for (v = 0; v < g->n && ok; v++){
+		for (k = g->offsets[v]; k < g->offsets[v + 1] && g->neighbors[k] < v; k++){
+			u = g->neighbors[k];
+			if (cur[u] == g->offsets[u + 1] || g->neighbors[cur[u]] != v){
+				ok = 0;
+				break;
+			}
+			cur[u]++;
+		}
+		cur[v] = k;
+	}
+	for (v = 0; v < g->n && ok; v++)
+		if (cur[v] != g->offsets[v + 1]) ok = 0;
+
+	free (cur);
+	return ok;
+}
+
+// Maps the CSR file in path into g
+// Returns 0 on success
+// Returns -1 if the file can't be read or is not a valid CSR file
+static inline int csr_open (const char* path, csr_graph* g){
+	struct stat st;
+	const csr_header* h;
+	size_t data;
+	int fd;
+
+	fd = open (path, O_RDONLY);
+	if (fd < 0) return -1;
+
+	if (fstat (fd, &st) || (size_t) st.st_size < sizeof(csr_header)){
+		close (fd);
+		return -1;
+	}
+
+	g->map_size = st.st_size;
+	g->map = mmap (NULL, g->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (g->map == MAP_FAILED) return -1;
+
+	h = (const csr_header*) g->map;
+	g->n = h->n;
+	g->m = h->m;
+
+	// The header must match the size of the file, which is compared
+	// by parts so that a huge n or m can't overflow
+	data = g->map_size - sizeof(csr_header);
+	if (memcmp (h->magic, CSR_MAGIC, 8) || h->version != CSR_VERSION ||
+		g->n >= data / sizeof(uint64_t) ||
+		g->m != (data - (g->n + 1) * sizeof(uint64_t)) / sizeof(uint32_t) ||
+		(data - (g->n + 1) * sizeof(uint64_t)) % sizeof(uint32_t)){
+		munmap (g->map, g->map_size);
+		return -1;
+	}
+
+	g->offsets = (const uint64_t*) ((const char*) g->map + sizeof(csr_header));
+	g->neighbors = (const uint32_t*) (g->offsets + g->n + 1);
+
+	// The lists are read in order, so the kernel may read ahead
+	madvise (g->map, g->map_size, MADV_SEQUENTIAL);
+
+	if (!csr_valid (g)){
+		munmap (g->map, g->map_size);
+		return -1;
+	}
+
+	return 0;
+}
+
+// Unmaps the file of g
+static inline void csr_close (csr_graph* g){
+	munmap (g->map, g->map_size);
+	g->map = NULL;
+}
+
+// Returns the degree of v
+static inline uint64_t csr_degree (const csr_graph* g, uint64_t v){
+	return g->offsets[v + 1] - g->offsets[v];
+}
+
+// Returns 1 if there is an edge connecting u and v
+// Returns 0 otherwise
+// Uses a binary search in the sorted neighbors of u
+static inline int csr_has_edge (const csr_graph* g, uint64_t u, uint64_t v){
+	uint64_t lo = g->offsets[u], hi = g->offsets[u + 1];
+
+	while (lo < hi){
+		uint64_t mid = lo + (hi - lo) / 2;
+		if (g->neighbors[mid] < v) lo = mid + 1;
+		else hi = mid;
+	}
+
+	return lo < g->offsets[u + 1] && g->neighbors[lo] == v;
+}
+
+// Writes a graph with n vertices and m entries as a CSR file in path
+// Returns 0 on success
+// Returns -1 otherwise
+static inline int csr_write (const char* path, uint64_t n, uint64_t m, const uint64_t* offsets, const uint32_t* neighbors){
+	csr_header h;
+	FILE* f;
+	int ok;
+
+	memset (&h, 0, sizeof(h));
+	memcpy (h.magic, CSR_MAGIC, 8);
+	h.version = CSR_VERSION;
+	h.n = n;
+	h.m = m;
+
+	f = fopen (path, "wb");
+	if (!f) return -1;
+
+	ok = fwrite (&h, sizeof(h), 1, f) == 1;
+	ok = ok && fwrite (offsets, sizeof(uint64_t), n + 1, f) == n + 1;
+	ok = ok && (m == 0 || fwrite (neighbors, sizeof(uint32_t), m, f) == m);
+
+	if (fclose (f)) ok = 0;
+
+	return ok ? 0 : -1;
+}
+
+// Writes the adjacency matrix M with V vertices as a CSR file in path
+// Returns 0 on success
+// Returns -1 otherwise
+static inline int csr_write_matrix (const char* path, const int* M, int V){
+	uint64_t* offsets;
+	uint32_t* neighbors;
+	uint64_t m = 0;
+	int i, j, r;
+
+	offsets = (uint64_t*) calloc (V + 1, sizeof(uint64_t));
+	if (!offsets) return -1;
+
+	for (i = 0; i < V; i++)
+		for (j = 0; j < V; j++)
+			if ( *(M + i*V + j) ) m++;
+
+	neighbors = (uint32_t*) malloc ((m ? m : 1) * sizeof(uint32_t));
+	if (!neighbors){
+		free (offsets);
+		return -1;
+	}
+
+	m = 0;
+	for (i = 0; i < V; i++){
+		offsets[i] = m;
+		for (j = 0; j < V; j++)
+			if ( *(M + i*V + j) ) neighbors[m++] = j;
+	}
+	offsets[V] = m;
+
+	r = csr_write (path, V, m, offsets, neighbors);
+
+	free (offsets);
+	free (neighbors);
+
+	return r;
+}
+
+// Creates the adjacency matrix of g, as the C tools use
+// Returns NULL if there is no memory
+static inline int* csr_to_matrix (const csr_graph* g){
+	uint64_t v, k;
+	int* M;
+
+	M = (int*) calloc (g->n * g->n, sizeof(int));
+	if (!M) return NULL;
+
+	for (v = 0; v < g->n; v++)
+		for (k = g->offsets[v]; k < g->offsets[v + 1]; k++)
+			*(M + v*g->n + g->neighbors[k]) = 1;
+
+	return M;
+}
+
+#endif
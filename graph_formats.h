@@ -0,0 +1,347 @@
+#ifndef GRAPH_FORMATS_H
+#define GRAPH_FORMATS_H
+
+// Readers for standard graph formats, for the C++ tools
+//
+// dimacs: "c" comments, "p edge N M", then "e u v" lines, vertices from 1
+// metis:  "%" comments, "n m [fmt [ncon]]", then line i has the neighbors
+//         of vertex i, from 1, with the weights fmt says
+// mtx:    Matrix Market coordinate matrix, "i j [value]" lines, from 1
+// snap:   "#" comments, then "u v" lines, vertices from 0
+//
+// The file is mapped in memory and split in chunks of whole lines,
+// which are parsed at the same time with std::from_chars
+// The result is a CSR graph as in graph_csr.h: sorted lists,
+// each edge in both lists, no loops and no repeated edges
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "graph_csr.h"
+
+struct CsrGraph {
+	uint64_t n = 0;
+	std::vector<uint64_t> offsets; // n + 1 positions in neighbors
+	std::vector<uint32_t> neighbors;
+};
+
+typedef std::vector<std::pair<uint32_t, uint32_t>> EdgeList;
+
+// Text file mapped in memory, unmapped when it goes out of scope
+class MappedText {
+	void* map = NULL;
+	size_t size = 0;
+
+public:
+	const char* begin = NULL;
+	const char* end = NULL;
+
+	MappedText(const char* path) {
+		struct stat st;
+		int fd = open(path, O_RDONLY);
+		if (fd < 0)
+			return;
+		if (!fstat(fd, &st) && st.st_size > 0) {
+			size = st.st_size;
+			map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (map == MAP_FAILED)
+				map = NULL;
+			else {
+				madvise(map, size, MADV_SEQUENTIAL);
+				begin = (const char*) map;
+				end = begin + size;
+			}
+		}
+		close(fd);
+	}
+
+	~MappedText() {
+		if (map)
+			munmap(map, size);
+	}
+
+	bool isOpen() {
+		return map != NULL;
+	}
+};
+
+// Returns the start of the line after p
+inline const char* next_line(const char* p, const char* end) {
+	const char* nl = (const char*) memchr(p, '\n', end - p);
+	return nl ? nl + 1 : end;
+}
+
+// Reads the next unsigned integer of the line [p, end) into x
+// and moves p after it
+// Returns false if the line has no more numbers
+inline bool next_uint(const char*& p, const char* end, uint64_t& x) {
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		p++;
+	auto r = std::from_chars(p, end, x);
+	if (r.ec != std::errc())
+		return false;
+	p = r.ptr;
+	return true;
+}
+
+// Skips the next token of the line [p, end), a number of any kind
+inline void skip_token(const char*& p, const char* end) {
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	while (p < end && *p != ' ' && *p != '\t' && *p != '\r')
+		p++;
+}
+
+// Number of threads used to parse and build the graphs
+inline int parse_threads() {
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Splits [begin, end) in chunks of whole lines, one per thread,
+// and calls parse_line(line, line_end, edges) for each line
+// Returns the edges found by all the threads
+template <typename F>
+EdgeList parse_lines(const char* begin, const char* end, F parse_line) {
+	int threads = parse_threads();
+	if (end - begin < (1 << 20))
+		threads = 1;
+
+	// Chunk t is [cut[t], cut[t + 1])
+	std::vector<const char*> cut(threads + 1, end);
+	cut[0] = begin;
+	for (int t = 1; t < threads; t++)
+		cut[t] = next_line(std::max(cut[t - 1], begin + (end - begin) / threads * t), end);
+
+	std::vector<EdgeList> parts(threads);
+	std::vector<std::thread> pool;
+	auto worker = [&](int t) {
+		for (const char* p = cut[t]; p < cut[t + 1]; ) {
+			const char* q = next_line(p, cut[t + 1]);
+			parse_line(p, q, parts[t]);
+			p = q;
+		}
+	};
+	for (int t = 1; t < threads; t++)
+		pool.emplace_back(worker, t);
+	worker(0);
+	for (auto& th : pool)
+		th.join();
+
+	EdgeList edges = std::move(parts[0]);
+	for (int t = 1; t < threads; t++)
+		edges.insert(edges.end(), parts[t].begin(), parts[t].end());
+	return edges;
+}
+
+// Builds the CSR graph with n vertices from a list of edges
+// Each edge goes to both lists, loops and repeated edges are dropped
+inline void build_csr(uint64_t n, const EdgeList& edges, CsrGraph& g) {
+	g.n = n;
+	g.offsets.assign(n + 1, 0);
+
+	// Counting sort by the first vertex of each entry
+	for (auto& e : edges)
+		if (e.first != e.second)
+			g.offsets[e.first + 1]++, g.offsets[e.second + 1]++;
+	for (uint64_t v = 0; v < n; v++)
+		g.offsets[v + 1] += g.offsets[v];
+
+	std::vector<uint64_t> pos(g.offsets.begin(), g.offsets.end() - 1);
+	g.neighbors.resize(g.offsets[n]);
+	for (auto& e : edges) {
+		if (e.first != e.second) {
+			g.neighbors[pos[e.first]++] = e.second;
+			g.neighbors[pos[e.second]++] = e.first;
+		}
+	}
+
+	// Sorting each list and removing repetitions in place
+	uint64_t m = 0;
+	for (uint64_t v = 0; v < n; v++) {
+		auto first = g.neighbors.begin() + g.offsets[v], last = g.neighbors.begin() + g.offsets[v + 1];
+		std::sort(first, last);
+		last = std::unique(first, last);
+		g.offsets[v] = m;
+		m = std::copy(first, last, g.neighbors.begin() + m) - g.neighbors.begin();
+	}
+	g.offsets[n] = m;
+	g.neighbors.resize(m);
+}
+
+// Reads a DIMACS graph ("p edge N M" and "e u v" lines)
+inline bool read_dimacs(const char* begin, const char* end, CsrGraph& g) {
+	uint64_t n = 0, m;
+	const char* p = begin;
+
+	// The problem line comes before the edges
+	for (; p < end && *p != 'e'; p = next_line(p, end)) {
+		if (*p == 'p') {
+			const char* q = p + 1;
+			skip_token(q, end); // "edge" or "col"
+			if (!next_uint(q, end, n) || !next_uint(q, end, m))
+				return false;
+		}
+	}
+	// Neighbors are 32 bits, as in read_snap
+	if (!n || n > UINT32_MAX)
+		return false;
+
+	std::atomic<bool> ok(true);
+	EdgeList edges = parse_lines(p, end, [&](const char* l, const char* le, EdgeList& out) {
+		uint64_t u, v;
+		if (*l != 'e')
+			return;
+		l++;
+		if (next_uint(l, le, u) && next_uint(l, le, v) && u >= 1 && v >= 1 && u <= n && v <= n)
+			out.push_back({u - 1, v - 1});
+		else
+			ok = false;
+	});
+
+	build_csr(n, edges, g);
+	return ok;
+}
+
+// Reads a Matrix Market coordinate matrix as the adjacency of a graph
+inline bool read_mtx(const char* begin, const char* end, CsrGraph& g) {
+	uint64_t rows, cols, nnz;
+	const char* p = begin;
+
+	if (end - p < 14 || strncmp(p, "%%MatrixMarket", 14))
+		return false;
+	const char* header_end = next_line(p, end);
+	if (std::string(p, header_end).find("coordinate") == std::string::npos)
+		return false;
+
+	// Size line after the comments
+	for (p = header_end; p < end && (*p == '%' || *p == '\n' || *p == '\r'); p = next_line(p, end));
+	if (!next_uint(p, end, rows) || !next_uint(p, end, cols) || !next_uint(p, end, nnz) || rows != cols
+		|| rows > UINT32_MAX)
+		return false;
+	p = next_line(p, end);
+
+	std::atomic<bool> ok(true);
+	EdgeList edges = parse_lines(p, end, [&](const char* l, const char* le, EdgeList& out) {
+		uint64_t u, v;
+		if (*l == '%' || *l == '\n' || *l == '\r')
+			return;
+		if (next_uint(l, le, u) && next_uint(l, le, v) && u >= 1 && v >= 1 && u <= rows && v <= rows)
+			out.push_back({u - 1, v - 1});
+		else
+			ok = false;
+	});
+
+	build_csr(rows, edges, g);
+	return ok;
+}
+
+// Reads a SNAP edge list ("u v" lines and "#" comments)
+// There is no header, so n is the biggest vertex plus one
+inline bool read_snap(const char* begin, const char* end, CsrGraph& g) {
+	std::atomic<bool> ok(true);
+	EdgeList edges = parse_lines(begin, end, [&](const char* l, const char* le, EdgeList& out) {
+		uint64_t u, v;
+		if (*l == '#' || *l == '%' || *l == '\n' || *l == '\r')
+			return;
+		if (next_uint(l, le, u) && next_uint(l, le, v) && u < UINT32_MAX && v < UINT32_MAX)
+			out.push_back({u, v});
+		else
+			ok = false;
+	});
+
+	uint64_t n = 0;
+	for (auto& e : edges)
+		n = std::max(n, (uint64_t) std::max(e.first, e.second) + 1);
+
+	build_csr(n, edges, g);
+	return ok;
+}
+
+// Reads a METIS graph: the header, then the neighbors of each vertex
+// Line numbers are vertex numbers, so the lines of each chunk
+// are counted first and the chunks are parsed after
+inline bool read_metis(const char* begin, const char* end, CsrGraph& g) {
+	uint64_t n, m, fmt = 0, ncon = 1;
+	const char* p = begin;
+
+	for (; p < end && *p == '%'; p = next_line(p, end));
+	if (!next_uint(p, end, n) || !next_uint(p, end, m) || n > UINT32_MAX)
+		return false;
+	next_uint(p, end, fmt);
+	next_uint(p, end, ncon);
+	p = next_line(p, end);
+
+	// fmt has three digits: vertex sizes, vertex weights and edge weights
+	int skip = (fmt / 100 % 10 ? 1 : 0) + (fmt / 10 % 10 ? (int) ncon : 0);
+	bool edge_weights = fmt % 10;
+
+	// Vertex lines of each chunk, comments don't count
+	std::vector<const char*> lines;
+	for (; p < end; p = next_line(p, end))
+		if (*p != '%')
+			lines.push_back(p);
+	if (lines.size() < n)
+		return false;
+
+	int threads = std::min<uint64_t>(parse_threads(), std::max<uint64_t>(n / 4096, 1));
+	std::vector<EdgeList> parts(threads);
+	std::vector<std::thread> pool;
+	std::atomic<bool> ok(true);
+	auto worker = [&](int t) {
+		for (uint64_t v = n * t / threads; v < n * (t + 1) / threads; v++) {
+			const char* l = lines[v];
+			const char* le = next_line(l, end);
+			uint64_t u;
+			for (int k = 0; k < skip; k++)
+				skip_token(l, le);
+			while (next_uint(l, le, u)) {
+				if (u < 1 || u > n)
+					ok = false;
+				else if (v < u - 1) // The other end lists it too
+					parts[t].push_back({v, u - 1});
+				if (edge_weights)
+					skip_token(l, le);
+			}
+		}
+	};
+	for (int t = 1; t < threads; t++)
+		pool.emplace_back(worker, t);
+	worker(0);
+	for (auto& th : pool)
+		th.join();
+
+	EdgeList edges = std::move(parts[0]);
+	for (int t = 1; t < threads; t++)
+		edges.insert(edges.end(), parts[t].begin(), parts[t].end());
+
+	build_csr(n, edges, g);
+	return ok;
+}
+
+// Reads the file in path in the format named by format
+// (dimacs, metis, mtx or snap) into g
+// Returns false if the file can't be read or has errors
+inline bool read_graph_file(const std::string& format, const char* path, CsrGraph& g) {
+	MappedText text(path);
+	if (!text.isOpen())
+		return false;
+
+	if (format == "dimacs")
+		return read_dimacs(text.begin, text.end, g);
+	if (format == "metis")
+		return read_metis(text.begin, text.end, g);
+	if (format == "mtx")
+		return read_mtx(text.begin, text.end, g);
+	if (format == "snap")
+		return read_snap(text.begin, text.end, g);
+	return false;
+}
+
+#endif
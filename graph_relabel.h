@@ -0,0 +1,158 @@
+#ifndef GRAPH_RELABEL_H
+#define GRAPH_RELABEL_H
+
+// Relabeling of the vertices of a CSR graph, for the C++ tools
+//
+// degree: by decreasing degree, so the busiest lists are together
+// rcm:    reverse Cuthill-McKee, a breadth-first search from a vertex of
+//         minimal degree of each component, visiting the neighbors by
+//         increasing degree, and the order reversed
+// bfs:    breadth-first search from the first vertex of each component
+//
+// Neighbors get numbers close to their vertex, so the lists and the rows
+// the algorithms read together are close in memory. The tools solve the
+// relabeled graph and print the vertices with the numbers of the input
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "graph_formats.h"
+
+struct Relabeling {
+	std::vector<uint32_t> old_of; // Input vertex of each new vertex
+	std::vector<uint32_t> new_of; // New vertex of each input vertex
+	CsrGraph graph; // The relabeled graph
+};
+
+// Returns true if method is one of the methods above
+inline bool relabel_known(const std::string& method) {
+	return method == "degree" || method == "rcm" || method == "bfs";
+}
+
+// Order of the vertices for method, old_of of a Relabeling
+// Returns false if method is not known
+inline bool relabel_order(const std::string& method, uint64_t n, const uint64_t* offsets, const uint32_t* neighbors, std::vector<uint32_t>& order) {
+	if (!relabel_known(method))
+		return false;
+
+	auto degree = [&](uint32_t v) {
+		return offsets[v + 1] - offsets[v];
+	};
+
+	order.resize(n);
+	for (uint64_t v = 0; v < n; v++)
+		order[v] = v;
+
+	if (method == "degree") {
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+			return degree(a) > degree(b);
+		});
+		return true;
+	}
+
+	// The searches start from the vertices in this order, the ones
+	// already reached are skipped
+	std::vector<uint32_t> starts(order);
+	if (method == "rcm")
+		std::stable_sort(starts.begin(), starts.end(), [&](uint32_t a, uint32_t b) {
+			return degree(a) < degree(b);
+		});
+
+	// order is the queue of all the searches
+	std::vector<char> reached(n, 0);
+	uint64_t tail = 0;
+	for (uint32_t s : starts) {
+		if (reached[s])
+			continue;
+		reached[s] = 1;
+		order[tail++] = s;
+		for (uint64_t head = tail - 1; head < tail; head++) {
+			uint32_t v = order[head];
+			uint64_t first = tail;
+			for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++)
+				if (!reached[neighbors[k]]) {
+					reached[neighbors[k]] = 1;
+					order[tail++] = neighbors[k];
+				}
+			if (method == "rcm")
+				std::stable_sort(order.begin() + first, order.begin() + tail, [&](uint32_t a, uint32_t b) {
+					return degree(a) < degree(b);
+				});
+		}
+	}
+
+	if (method == "rcm")
+		std::reverse(order.begin(), order.end());
+	return true;
+}
+
+// Average distance between the numbers of the ends of the edges, and the
+// biggest one (the bandwidth of the adjacency matrix)
+inline double edge_span(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors, uint64_t& bandwidth) {
+	double total = 0;
+	bandwidth = 0;
+	for (uint64_t v = 0; v < n; v++)
+		for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++) {
+			uint64_t span = v > neighbors[k] ? v - neighbors[k] : neighbors[k] - v;
+			total += span;
+			bandwidth = std::max(bandwidth, span);
+		}
+	return offsets[n] ? total / offsets[n] : 0;
+}
+
+// Relabels the CSR graph with n vertices by method into r
+// and prints the time it took and the spans before and after to stderr
+// Returns false if method is not known
+inline bool relabel_graph(const std::string& method, uint64_t n, const uint64_t* offsets, const uint32_t* neighbors, Relabeling& r) {
+	auto start = std::chrono::steady_clock::now();
+	if (!relabel_order(method, n, offsets, neighbors, r.old_of))
+		return false;
+
+	r.new_of.resize(n);
+	for (uint64_t k = 0; k < n; k++)
+		r.new_of[r.old_of[k]] = k;
+
+	CsrGraph& g = r.graph;
+	g.n = n;
+	g.offsets.resize(n + 1);
+	g.neighbors.resize(offsets[n]);
+	g.offsets[0] = 0;
+	for (uint64_t k = 0; k < n; k++) {
+		uint32_t v = r.old_of[k];
+		uint64_t first = g.offsets[k];
+		for (uint64_t e = offsets[v]; e < offsets[v + 1]; e++)
+			g.neighbors[first + e - offsets[v]] = r.new_of[neighbors[e]];
+		g.offsets[k + 1] = first + offsets[v + 1] - offsets[v];
+		std::sort(g.neighbors.begin() + first, g.neighbors.begin() + g.offsets[k + 1]);
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	uint64_t band_before, band_after;
+	double before = edge_span(n, offsets, neighbors, band_before);
+	double after = edge_span(n, g.offsets.data(), g.neighbors.data(), band_after);
+	std::cerr << "Relabeled " << n << " vertices by " << method << " in " << ms << " ms: average edge span "
+		<< before << " -> " << after << ", bandwidth " << band_before << " -> " << band_after << "\n";
+
+	return true;
+}
+
+// Takes "--relabel METHOD" out of argv into method
+// Returns the number of arguments left
+inline int relabel_options(int argc, char* argv[], std::string& method) {
+	int left = 1;
+	for (int k = 1; k < argc; k++) {
+		if (k + 1 < argc && std::string(argv[k]) == "--relabel")
+			method = argv[++k];
+		else
+			argv[left++] = argv[k];
+	}
+
+	return left;
+}
+
+#endif
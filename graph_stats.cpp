@@ -0,0 +1,108 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "graph_csr.h"
+#include "graph_formats.h"
+#include "graph_components.h"
+
+// Prints the statistics of the CSR graph with n vertices to stdout: edges,
+// density, degrees and their histogram (see graph_components.h), and the
+// size of each component, biggest first, so a big input can be split by
+// component before it is solved
+// With labels set, writes the component of each vertex to it, one per line
+// The times of the parallel parts go to stderr
+int print_stats(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors, int threads, const std::string& labels) {
+	auto start = std::chrono::steady_clock::now();
+	DegreeStats d = degree_stats(n, offsets, threads);
+	auto degrees_done = std::chrono::steady_clock::now();
+	Components c;
+	label_components(n, offsets, neighbors, threads, c);
+	auto components_done = std::chrono::steady_clock::now();
+
+	std::cerr << "Degrees in " << std::chrono::duration<double, std::milli>(degrees_done - start).count()
+		<< " ms and components in " << std::chrono::duration<double, std::milli>(components_done - degrees_done).count()
+		<< " ms with " << threads << " threads\n";
+
+	uint64_t m = offsets[n] / 2;
+	std::cout << "Vertices = " << n << "\n";
+	std::cout << "Edges = " << m << "\n";
+	std::cout << "Density = " << (n > 1 ? 2.0 * m / ((double) n * (n - 1)) : 0) << "\n";
+	std::cout << "Degrees = min " << d.min << ", average " << (n ? (double) d.sum / n : 0) << ", max " << d.max << "\n";
+	for (size_t k = 0; k < d.buckets.size(); k++) {
+		if (k < 2)
+			std::cout << "Degree " << k << " = " << d.buckets[k] << "\n";
+		else
+			std::cout << "Degree " << (1ULL << (k - 1)) << "-" << (1ULL << k) - 1 << " = " << d.buckets[k] << "\n";
+	}
+
+	std::cout << "Components = " << c.sizes.size() << "\n";
+	for (size_t k = 0; k < c.sizes.size(); k++)
+		std::cout << "Component " << k << " = " << c.sizes[k] << "\n";
+
+	if (!labels.empty()) {
+		FILE* out = fopen(labels.c_str(), "w");
+		if (!out) {
+			std::cerr << "Could not write " << labels << "\n";
+			return 1;
+		}
+		for (uint64_t v = 0; v < n; v++)
+			fprintf(out, "%u\n", c.label[v]);
+		if (fclose(out)) {
+			std::cerr << "Could not write " << labels << "\n";
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Input the path of a binary CSR file, or "--dimacs", "--metis", "--mtx"
+// or "--snap" and the path of a file
+// "--threads N" sets the threads (one per core by default) and
+// "--labels FILE" writes the component of each vertex to FILE
+// Prints the statistics of the graph
+int main(int argc, char* argv[]) {
+	int threads = parse_threads();
+	std::string labels;
+	int left = 1;
+	for (int k = 1; k < argc; k++) {
+		std::string option = argv[k];
+		if (k + 1 < argc && option == "--threads")
+			threads = std::max(1, atoi(argv[++k]));
+		else if (k + 1 < argc && option == "--labels")
+			labels = argv[++k];
+		else
+			argv[left++] = argv[k];
+	}
+	argc = left;
+
+	if (argc >= 3 && argv[1][0] == '-') {
+		CsrGraph g;
+		if (!read_graph_file(argv[1] + 2, argv[2], g)) {
+			std::cerr << "Could not read " << argv[2] << " as " << argv[1] + 2 << "\n";
+			return 1;
+		}
+		return print_stats(g.n, g.offsets.data(), g.neighbors.data(), threads, labels);
+	}
+
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << " [--threads N] [--labels FILE] graph.csr\n";
+		std::cerr << "       " << argv[0] << " [--threads N] [--labels FILE] --dimacs|--metis|--mtx|--snap input\n";
+		return 1;
+	}
+
+	csr_graph g;
+	if (csr_open(argv[1], &g)) {
+		std::cerr << "Could not read " << argv[1] << " as a CSR file\n";
+		return 1;
+	}
+	int status = print_stats(g.n, g.offsets, g.neighbors, threads, labels);
+	csr_close(&g);
+
+	return status;
+}
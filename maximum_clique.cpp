@@ -3,442 +3,646 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <chrono>
+#include <string>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+
+// The maximum clique of G is the maximum independent set of !G,
+// so the loaders and the search come from the independent set tool,
+// which the clique search uses through the interface of MisSearch
+#ifdef NO_MAIN
+#include "maximum_independent_set.cpp"
+#else
+#define NO_MAIN
+#include "maximum_independent_set.cpp"
+#undef NO_MAIN
+#endif
+
+// Maximal cliques
+// Bron-Kerbosch with Tomita's pivot, in the order of Eppstein, Loffler and Strash:
+// each vertex v, in degeneracy order, lists the maximal cliques where it
+// is the first vertex, with the candidates P (its neighbors after it) and
+// the excluded vertices X (its neighbors before it) as bitsets over P U X
+// The outer loop runs in parallel and each clique is reported as it is
+// found, so they are never kept in memory
+typedef std::function<void(int thread, const std::vector<int>& clique)> CliqueReport;
+
+// Lists the maximal cliques of one vertex at a time, one for each thread
+// The threads read G and rank_of of the search that started them
+struct CliqueLister {
+	int thread;
+	const CliqueReport& report;
+	const std::vector<std::vector<int>>& graph;
+	const std::vector<int>& rank_of;
+	long long found = 0;
+	std::vector<int> local; // Vertex of G of each local index, P first and X after
+	size_t p; // Size of P at the start
+	size_t words, p_words; // Words of a set of P U X and of P
+	std::vector<uint64_t> rows; // Neighbors of each vertex of P in P U X, words words each
+	std::vector<uint64_t> x_rows; // Neighbors of each vertex of X in P, p_words words each
+	std::vector<uint64_t> sets; // P and X of each depth of the search
+	std::vector<int> clique, sorted;
+
+	CliqueLister(int thread, const CliqueReport& report, const std::vector<std::vector<int>>& graph, const std::vector<int>& rank_of)
+		: thread(thread), report(report), graph(graph), rank_of(rank_of) {}
+
+	const uint64_t* row(size_t u) {
+		return u < p ? &rows[u * words] : &x_rows[(u - p) * p_words];
+	}
 
-//Global variables
-int mat[100][100];
-
-int N_vertices;
-
-// Declarations
-int find(std::vector<int>& parent, int i);
-void unite(std::vector<int>& parent, int x, int y);
-bool edge(int i, int j);
-void edit_edge(int i, int j, int value);
-std::set<int> bigst_set(std::set<int> A, std::set<int> B);
-std::set<int> set_U(std::set<int> A, std::set<int> B);
-std::set<int> set_M(std::set<int> A, std::set<int> B);
-std::set<int> set_I(std::set<int> A, std::set<int> B);
-bool set_S(std::set<int> A, std::set<int> B);
-std::vector<std::set<int>> connected_components(std::set<int> vertices);
-std::map<int, int> degrees(std::set<int> X);
-bool cmp_second(std::pair<int, int> a, std::pair<int, int> b);
-std::set<int> N(int v, std::set<int> X);
-std::set<int> N_C(int v, std::set<int> X);
-std::set<int> N2(int v, std::set<int> X);
-bool dominates(int v, int u, std::set<int> X);
-void complement_graph();
-std::set<int> MIS1(std::set<int> X, std::set<int> S);
-std::set<int> MIS2(std::set<int> X, std::set<int> S);
-std::set<int> MIS(std::set<int> X);
+	// adjacent and linked in the G of the lister
+	bool adjacent(int u, int v) const {
+		return std::binary_search(graph[u].begin(), graph[u].end(), v);
+	}
 
+	bool linked(int u, int v) const {
+		return graph[u].size() <= graph[v].size() ? adjacent(u, v) : adjacent(v, u);
+	}
 
+	void list(int v);
+	void expand(int depth);
+};
 
-//Definitions
+// State of the clique search of one graph
+// mis loads G and its options apply to the searches of the complements
+struct CliqueSearch {
+	MisSearch mis;
 
-// Implementation of union-find algorithm
+	// G is kept here while mis searches the complement of a subgraph
+	std::vector<std::vector<int>> graph, complement;
+	std::vector<int> core; // Core number of each vertex
+	std::vector<int> degeneracy_order, rank_of; // rank_of[v] is the position of v in degeneracy_order
+	std::vector<int> slot; // Position of each vertex in the current subgraph, or -1
 
-// Find function:
-int find(std::vector <int>& parent, int i) {
-	if (parent[i] == i)
-		return i;
-	return find(parent, parent[i]);
-}
+	std::string maximal_path; // File of the maximal cliques, "-" for stdout
+	int clique_threads = 0; // 0 for one thread per core
 
-// Union function:
-void unite(std::vector <int>& parent, int x, int y) {
-	int xset = find(parent, x);
-	int yset = find(parent, y);
-	parent[yset] = xset;
-}
+	// Declarations
+	bool adjacent(int u, int v);
+	bool linked(int u, int v);
+	void core_decomposition();
+	std::vector<int> greedy_clique();
+	std::vector<int> strip_candidates(int v, int best);
+	void complement_subgraph(const std::vector<int>& vertices);
+	std::set<int> clique_of(const std::vector<int>& vertices, std::set<int> found);
+	std::set<int> maximum_clique();
+	long long maximal_cliques(int threads, const CliqueReport& report);
+	int write_maximal_cliques(const char* path, int threads);
+	int clique_options(int argc, char* argv[]);
+};
 
-// Returns true if there is an edge connecting i and j
-// Returns false otherwise
-bool edge(int i, int j) {
-	return mat[i][j];
-}
 
-// Modify the value of an edge between vertices i and j
-void edit_edge(int i, int j, int value) {
-	mat[i][j] = value;
-}
 
-// Returns the biggest set
-// Chooses the first in case of draw
-std::set<int> bigst_set(std::set<int> A, std::set<int> B) {
-	if (A.size() < B.size())
-		return B;
-	else
-		return A;
-}
-
-// Returns the union of two sets A U B
-std::set<int> set_U(std::set<int> A, std::set<int> B) {
-	std::set<int> result = A;
-	result.insert(B.begin(), B.end());
+//Definitions
 
-	return result;
+// Returns true if u and v are adjacent in G
+bool CliqueSearch::adjacent(int u, int v) {
+	return std::binary_search(graph[u].begin(), graph[u].end(), v);
 }
 
-// Returns the difference of two sets A\B
-std::set<int> set_M(std::set<int> A, std::set<int> B) {
-	std::set<int> result = A;
-	for (auto& it : B) {
-		if (A.count(it))
-			result.erase(it);
-	}
-
-	return result;
+// Same as adjacent, searching the shortest list
+bool CliqueSearch::linked(int u, int v) {
+	return graph[u].size() <= graph[v].size() ? adjacent(u, v) : adjacent(v, u);
 }
 
-// Returns the intersection of two sets A and B
-std::set<int> set_I(std::set<int> A, std::set<int> B) {
-	std::set<int> result;
-
-	for (auto& it : A) {
-		if (B.count(it))
-			result.insert(it);
+// Computes the core number of each vertex of G and a degeneracy ordering,
+// where each vertex has at most core[v] neighbors after it, in O(n + m):
+// vertices are taken out lowest degree first, with a bucket for each degree
+// (Batagelj and Zaversnik)
+void CliqueSearch::core_decomposition() {
+	int n = graph.size(), max_degree = 0;
+	core.assign(n, 0);
+	for (int v = 0; v < n; v++) {
+		core[v] = graph[v].size();
+		max_degree = std::max(max_degree, core[v]);
 	}
 
-	return result;
-}
-
-// Returns true if A is subset of B
-// Returns false otherwise
-bool set_S(std::set<int> A, std::set<int> B) {
-	for (auto& it : A)
-		if (!B.count(it))
-			return false;
-
-	return true;
-}
+	// bucket[d] is the start of the vertices of degree d in degeneracy_order
+	std::vector<int> bucket(max_degree + 1, 0);
+	for (int v = 0; v < n; v++)
+		bucket[core[v]]++;
+	for (int d = 0, start = 0; d <= max_degree; d++) {
+		int size = bucket[d];
+		bucket[d] = start;
+		start += size;
+	}
 
-// Returns a vector of sets
-// Each set has all the vertices in the same component
-// There is no path connecting vertices from different sets
-// using only the vertices in "vertices" set
-std::vector<std::set<int>> connected_components(std::set<int> vertices) {
-	int size = vertices.size();
-	std::vector <int> parent;
-	std::vector <std::set<int>> components;
-	std::vector <std::set<int>> result;
-	parent.resize(size);
-	components.resize(size);
-
-	// Using union-find to identify the components
-	for (int i = 0; i < size; i++)
-		parent[i] = i;
-
-	for (auto i = vertices.begin(); i != vertices.end(); i++) {
-		for (auto j = i; j != vertices.end(); j++) {
-			if (edge(*i, *j)) {
-				unite(parent, distance(vertices.begin(), i), distance(vertices.begin(), j));
+	degeneracy_order.resize(n);
+	rank_of.resize(n);
+	for (int v = 0; v < n; v++) {
+		rank_of[v] = bucket[core[v]]++;
+		degeneracy_order[rank_of[v]] = v;
+	}
+	for (int d = max_degree; d > 0; d--)
+		bucket[d] = bucket[d - 1];
+	bucket[0] = 0;
+
+	for (int i = 0; i < n; i++) {
+		int v = degeneracy_order[i];
+		for (int u : graph[v]) {
+			if (core[u] <= core[v])
+				continue;
+
+			// u moves to the start of its bucket, which loses it
+			int d = core[u], first = degeneracy_order[bucket[d]];
+			if (first != u) {
+				std::swap(degeneracy_order[rank_of[u]], degeneracy_order[bucket[d]]);
+				std::swap(rank_of[u], rank_of[first]);
 			}
+			bucket[d]++;
+			core[u]--;
 		}
 	}
+}
 
-	// Making a vector of sets with the vertices in each component
-	for (auto i = vertices.begin(); i != vertices.end(); i++) {
-		components[find(parent, distance(vertices.begin(), i))].insert(*i);
-	}
-
-	// Excluding empty sets
-	for (auto i = components.begin(); i != components.end(); i++) {
-		if (!(*i).empty())
-			result.push_back(*i);
+// Builds a clique from each vertex v with its neighbors after it in the
+// degeneracy ordering, highest core number first, and returns the biggest
+// A clique with v has at most core[v] + 1 vertices, so most are skipped
+std::vector<int> CliqueSearch::greedy_clique() {
+	std::vector<int> best, clique, later;
+
+	for (int v : degeneracy_order) {
+		if (core[v] + 1 <= (int) best.size())
+			continue;
+
+		later.clear();
+		for (int w : graph[v])
+			if (rank_of[w] > rank_of[v])
+				later.push_back(w);
+		std::sort(later.begin(), later.end(), [&](int a, int b) {
+			return core[a] > core[b];
+		});
+
+		clique.assign(1, v);
+		for (int w : later) {
+			bool all = true;
+			for (size_t k = 1; k < clique.size() && all; k++)
+				all = adjacent(w, clique[k]);
+			if (all)
+				clique.push_back(w);
+		}
+		if (clique.size() > best.size())
+			best = clique;
 	}
 
-	return result;
+	return best;
 }
 
-// Returns a map with {key : value} = {vertex : degree}
-// considering only vertices in X
-std::map<int, int> degrees(std::set<int> X) {
-	std::map<int, int> d;
-
-	for (auto i = X.begin(); i != X.end(); i++)
-		d.insert({ *i, 0 });
-
-	for (auto i = X.begin(); i != X.end(); i++) {
-		for (auto j = i; j != X.end(); j++) {
-			if (edge(*i, *j)) {
-				d[*i]++;
-				d[*j]++;
+// Returns the neighbors of v after it in the degeneracy ordering that can be
+// in a clique of more than best vertices with v: their core number is at
+// least best, and they keep best - 1 neighbors among themselves when the
+// ones that don't are stripped one at a time
+// Returns an empty list if they are less than best
+std::vector<int> CliqueSearch::strip_candidates(int v, int best) {
+	std::vector<int> candidates;
+	for (int w : graph[v])
+		if (rank_of[w] > rank_of[v] && core[w] >= best)
+			candidates.push_back(w);
+	if ((int) candidates.size() < best)
+		return std::vector<int>();
+
+	int k = candidates.size();
+	for (int i = 0; i < k; i++)
+		slot[candidates[i]] = i;
+
+	// Degrees in the subgraph of the candidates
+	std::vector<int> d(k, 0), stripped;
+	std::vector<char> gone(k, 0);
+	for (int i = 0; i < k; i++) {
+		for (int u : graph[candidates[i]])
+			if (slot[u] >= 0)
+				d[i]++;
+		if (d[i] < best - 1) {
+			gone[i] = 1;
+			stripped.push_back(i);
+		}
+	}
+	while (!stripped.empty()) {
+		int i = stripped.back();
+		stripped.pop_back();
+		for (int u : graph[candidates[i]]) {
+			int j = slot[u];
+			if (j >= 0 && !gone[j] && --d[j] < best - 1) {
+				gone[j] = 1;
+				stripped.push_back(j);
 			}
 		}
 	}
 
-	return d;
-}
+	std::vector<int> left;
+	for (int i = 0; i < k; i++) {
+		slot[candidates[i]] = -1;
+		if (!gone[i])
+			left.push_back(candidates[i]);
+	}
+	if ((int) left.size() < best)
+		left.clear();
 
-// Function to sort a vector of pairs by the second value
-bool cmp_second(std::pair<int, int> a, std::pair<int, int> b) {
-	return a.second < b.second;
+	return left;
 }
 
-// Returns the set of neighboors of v that are in X
-std::set<int> N(int v, std::set<int> X) {
-	std::set<int> result;
-	for (auto& it : X) {
-		if (edge(v, it))
-			result.insert(it);
+// Gives mis the complement of the subgraph of G induced by vertices,
+// where vertex i is vertices[i], so its maximum independent set
+// is the maximum clique of the subgraph
+void CliqueSearch::complement_subgraph(const std::vector<int>& vertices) {
+	int k = vertices.size();
+	for (int i = 0; i < k; i++)
+		slot[vertices[i]] = i;
+
+	complement.assign(k, std::vector<int>());
+	std::vector<char> neighbor(k);
+	for (int i = 0; i < k; i++) {
+		std::fill(neighbor.begin(), neighbor.end(), 0);
+		for (int u : graph[vertices[i]])
+			if (slot[u] >= 0)
+				neighbor[slot[u]] = 1;
+		for (int j = 0; j < k; j++)
+			if (j != i && !neighbor[j])
+				complement[i].push_back(j);
 	}
+	mis.swap_graph(complement);
 
-	return result;
+	for (int v : vertices)
+		slot[v] = -1;
 }
 
-// Returns the set of neighboors of v that are in X, including v
-std::set<int> N_C(int v, std::set<int> X) {
-	return set_U(N(v, X), { v });
+// Returns the vertices of G of a set found in the subgraph of vertices
+std::set<int> CliqueSearch::clique_of(const std::vector<int>& vertices, std::set<int> found) {
+	std::set<int> clique;
+	for (int i : found)
+		clique.insert(vertices[i]);
+	return clique;
 }
 
-// Returns the neighboors of the neighboors of v
-// excluding the neighboors of v and v
-std::set<int> N2(int v, std::set<int> X) {
-	std::set<int> result;
-	std::set<int> neighboors = N(v, X);
-
-	for (auto& it : neighboors)
-		result = set_U(result, N(it, X));
-
-	result = set_M(result, neighboors);
-	result.erase(v);
+// Returns the maximum clique of G, the graph of mis
+// The greedy clique gives the first best size. Then, in degeneracy order,
+// each vertex v is searched with the neighbors after it that
+// strip_candidates keeps, if they may beat the best clique; these
+// subgraphs have at most degeneracy vertices
+// A single search (checkpoints, limits, local search or warm start)
+// searches the vertices with core number at least the best size instead
+// search_progress gets the nodes of all the searches and the best clique,
+// and cancel_flag stops them with the best clique found and the bound of
+// the core numbers
+// The graph is left in mis as it was
+std::set<int> CliqueSearch::maximum_clique() {
+	mis.swap_graph(graph);
+	int n = graph.size();
+	slot.assign(n, -1);
+	core_decomposition();
+
+	std::vector<int> greedy = greedy_clique();
+	std::set<int> best(greedy.begin(), greedy.end());
+	int best_size = best.size();
+	bool single = !mis.checkpoint_path.empty() || !mis.resume_path.empty() || mis.node_limit || mis.time_limit
+		|| mis.local_search_time || mis.warm_start_time;
+
+	// The searches report sets of the complement of subgraphs, and the
+	// short ones, which report nothing, are reported between them
+	auto progress = mis.search_progress;
+	auto last_progress = std::chrono::steady_clock::now();
+	long long nodes = 0;
+	if (progress)
+		mis.search_progress = [&](long long expanded, int found) {
+			progress(nodes + expanded, std::max(best_size, found + (single ? 0 : 1)));
+			last_progress = std::chrono::steady_clock::now();
+		};
+
+	if (single) {
+		std::vector<int> vertices;
+		for (int v = 0; v < n; v++)
+			if (core[v] >= best_size)
+				vertices.push_back(v);
+		complement_subgraph(vertices);
+
+		std::set<int> X;
+		for (int i = 0; i < mis.N_vertices; i++)
+			X.insert(i);
+		std::set<int> found = mis.MIS(X);
+		if (found.size() > best.size())
+			best = clique_of(vertices, found);
+		mis.search_bound = std::max(mis.search_bound, best_size);
+	}
+	else {
+		bool cancelled = false;
+		int bound = best_size;
+		for (int v : degeneracy_order) {
+			if (core[v] < best_size)
+				continue;
+			if (mis.cancel_flag && *mis.cancel_flag) {
+				cancelled = true;
+				bound = std::max(bound, core[v] + 1);
+				continue;
+			}
+			std::vector<int> vertices = strip_candidates(v, best_size);
+			if (vertices.empty())
+				continue;
+
+			complement_subgraph(vertices);
+			std::set<int> X;
+			for (int i = 0; i < mis.N_vertices; i++)
+				X.insert(i);
+			std::set<int> found = mis.MIS(X);
+			nodes += mis.search_nodes;
+			if (mis.search_cancelled) {
+				cancelled = true;
+				bound = std::max(bound, std::min(core[v] + 1, mis.search_bound + 1));
+			}
+			if ((int) found.size() + 1 > best_size) {
+				best = clique_of(vertices, found);
+				best.insert(v);
+				best_size = best.size();
+			}
+			auto now = std::chrono::steady_clock::now();
+			if (progress && now - last_progress >= std::chrono::duration<double, std::milli>(mis.progress_interval)) {
+				progress(nodes, best_size);
+				last_progress = now;
+			}
+		}
+		mis.search_finished = true;
+		mis.search_limited = mis.search_cancelled = cancelled;
+		mis.search_bound = std::max(bound, best_size);
+		mis.search_nodes = nodes;
+	}
+	mis.search_progress = progress;
 
-	return result;
-}
+	mis.swap_graph(graph);
+	graph.clear();
 
-// Returns true if vertex v dominates vertex u
-// Returns false otherwise
-bool dominates(int v, int u, std::set<int> X) {
-	return set_S(N_C(v, X), N_C(u, X));
+	return best;
 }
 
-// Makes the complement graph in-place (overwrite actual graph)
-// Doesn't edit the main diagonal beacause it has no loops
-void complement_graph() {
-	for (int i = 0; i < N_vertices; i++) {
-		for (int j = i+1; j < N_vertices; j++) {
-			edit_edge(i, j, !edge(i, j));
-			edit_edge(j, i, !edge(j, i));
-		}
+// Lists the maximal cliques where v is the first vertex
+// in the degeneracy ordering
+// P has at most degeneracy vertices, so the edges are found by searching
+// the lists of the pairs with an end in P, instead of going through them
+void CliqueLister::list(int v) {
+	local.clear();
+	for (int w : graph[v])
+		if (rank_of[w] > rank_of[v])
+			local.push_back(w);
+	p = local.size();
+
+	// A vertex before v with no neighbor in P leaves X at the first branch,
+	// so it only matters when P is empty
+	bool excluded = false;
+	for (int w : graph[v]) {
+		if (rank_of[w] > rank_of[v])
+			continue;
+		excluded = true;
+		for (size_t i = 0; i < p; i++)
+			if (linked(w, local[i])) {
+				local.push_back(w);
+				break;
+			}
 	}
-}
-
-// Returns the maximum independent set including only X vertices
-// that has exactly one element of S (|S| = 2)
-std::set<int> MIS1(std::set<int> X, std::set<int> S) {
-	auto it1 = S.begin();
-	int s1 = (*it1);
-	std::advance(it1, 1);
-	int s2 = (*it1);
-	std::map<int, int> deg = degrees(X);
-
-	// To make sure d(s1) <= d(s2)
-	if (deg[s1] > deg[s2]) {
-		int aux = s2;
-		s2 = s1;
-		s1 = aux;
+	if (p == 0) {
+		if (!excluded) {
+			found++;
+			report(thread, std::vector<int>(1, v));
+		}
+		return;
 	}
 
-	if (deg[s1] <= 1)
-		return MIS(X);
-
-	if (edge(s1, s2)) {
-		if (deg[s1] <= 3)
-			return MIS(X);
-		return bigst_set(set_U(MIS(set_M(X, N_C(s1, X))), { s1 }), set_U(MIS(set_M(X, N_C(s2, X))), { s2 }));
+	// Only edges with an end in P are needed: X only loses vertices
+	// and the pivot is chosen by its neighbors in P
+	size_t k = local.size();
+	words = k / 64 + 1;
+	p_words = p / 64 + 1;
+	rows.assign(p * words, 0);
+	x_rows.assign((k - p) * p_words, 0);
+	for (size_t i = 0; i < p; i++) {
+		for (size_t j = i + 1; j < k; j++) {
+			if (!linked(local[i], local[j]))
+				continue;
+			rows[i * words + j / 64] |= 1ULL << (j % 64);
+			if (j < p)
+				rows[j * words + i / 64] |= 1ULL << (i % 64);
+			else
+				x_rows[(j - p) * p_words + i / 64] |= 1ULL << (i % 64);
+		}
 	}
 
-	if (!set_I(N(s1, X), N(s2, X)).empty())
-		return MIS1(set_M(X, set_I(N(s1, X), N(s2, X))), S);
-
-	if (deg[s2] == 2) {
-		std::set<int> Ns1 = N(s1, X);
-		auto it2 = Ns1.begin();
-		int e = *it2;
-		std::advance(it2, 1);
-		int f = *it2;
-
-		if (edge(e, f))
-			return set_U(MIS(set_M(X, N_C(s1, X))), { s1 });
-
-		if (set_S(set_M(set_U(N(e, X), N(f, X)), { s1 }), N(s2, X)))
-			return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s2, X)))), { e, f, s2 });
+	// Each depth takes a vertex out of P, so there are at most p + 1
+	sets.assign((p + 2) * 2 * words, 0);
+	for (size_t i = 0; i < k; i++)
+		sets[(i < p ? 0 : words) + i / 64] |= 1ULL << (i % 64);
 
-		return bigst_set(set_U(MIS(set_M(X, N_C(s1, X))), { s1 }), set_U(MIS(set_M(X, set_U(N_C(e, X), set_U(N_C(f, X), N_C(s2, X))))), { e, f, s2 }));
-	}
-
-	return bigst_set(set_U(MIS(set_M(X, N_C(s2, X))), { s2 }), set_U(MIS2(set_M(X, set_U(N_C(s1, X), { s2 })), N(s2, X)), { s1 }));
+	clique.assign(1, v);
+	expand(0);
 }
 
-// Returns the maximum independent set including only X vertices
-// with at least two elements of S
-std::set<int> MIS2(std::set<int> X, std::set<int> S) {
-	std::map<int, int> deg = degrees(X);
-	std::vector<std::pair<int, int>> sorted_degrees; // We use vector of pair to sort the degree map
-	for (auto& it : deg)
-		sorted_degrees.push_back(it);
-	std::sort(sorted_degrees.begin(), sorted_degrees.end(), cmp_second);
-
-
-	std::set<int> result;
-	if (S.size() <= 1)
-		return result;
-
-	auto it = sorted_degrees.begin();
-	int s1 = (*it).first;
-	advance(it, 1);
-	int s2 = (*it).first;
-
-	if (S.size() == 2) {
-		if (edge(s1, s2))
-			return result;
-		return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s2, X)))), { s1, s2 });
+// Reports the clique if P and X are empty, or else branches on
+// the vertices of P that aren't neighbors of the pivot, the vertex
+// of P U X with the most neighbors in P
+void CliqueLister::expand(int depth) {
+	uint64_t* P = &sets[2 * depth * words];
+	uint64_t* X = P + words;
+
+	bool p_empty = true, x_empty = true;
+	for (size_t w = 0; w < words; w++) {
+		p_empty = p_empty && !P[w];
+		x_empty = x_empty && !X[w];
 	}
-
-	advance(it, 1);
-	int s3 = (*it).first;
-
-	if (S.size() == 3) {
-		if (deg[s1] == 0)
-			set_U(MIS1(set_M(X, { s1 }), set_M(S, { s1 })), { s1 });
-
-		if (edge(s1, s2) && edge(s2, s3) && edge(s3, s1))
-			return result;
-
-		if (edge(s1, s2) && edge(s1, s3))
-			return set_U(MIS(set_M(X, set_U(N_C(s2, X), N_C(s3, X)))), { s2, s3 });
-
-		if (edge(s2, s1) && edge(s2, s3))
-			return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s3, X)))), { s1, s3 });
-
-		if (edge(s3, s1) && edge(s3, s2))
-			return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s2, X)))), { s1, s2 });
-
-		if (edge(s1, s2))
-			return set_U(MIS1(set_M(X, N_C(s3, X)), { s1, s2 }), { s3 });
-
-		if (edge(s2, s3))
-			return set_U(MIS1(set_M(X, N_C(s1, X)), { s2, s3 }), { s1 });
-
-		if (edge(s3, s1))
-			return set_U(MIS1(set_M(X, N_C(s2, X)), { s1, s3 }), { s2 });
-
-		std::set<int> intersec;
-
-		intersec = set_I(N(s1, X), N(s2, X));
-		if (!intersec.empty())
-			return MIS2(set_M(X, { *(intersec.begin()) }), S);
-
-		intersec = set_I(N(s2, X), N(s3, X));
-		if (!intersec.empty())
-			return MIS2(set_M(X, { *(intersec.begin()) }), S);
-
-		intersec = set_I(N(s1, X), N(s3, X));
-		if (!intersec.empty())
-			return MIS2(set_M(X, { *(intersec.begin()) }), S);
-
-		if (deg[s1] == 1)
-			return set_U(MIS1(set_M(X, N_C(s1, X)), set_M(S, { s1 })), { s1 });
-
-		return bigst_set(set_U(MIS1(set_M(X, N_C(s1, X)), set_M(S, { s1 })), { s1 }), MIS2(set_M(X, set_U(set_U(N_C(s2, X), N_C(s3, X)), { s1 })), N(s1, X)));
+	if (p_empty) {
+		if (x_empty) {
+			found++;
+			sorted = clique;
+			std::sort(sorted.begin(), sorted.end());
+			report(thread, sorted);
+		}
+		return;
 	}
 
-	if (S.size() == 4) {
-		// If exists v with d(v) <= 3
-		if (sorted_degrees[0].second <= 3)
-			return MIS(X);
-
-		return bigst_set(set_U(MIS(set_M(X, N_C(s1, X))), { s1 }), MIS2(set_M(X, { s1 }), set_M(S, { s1 })));
+	int pivot = -1, most = -1;
+	for (size_t w = 0; w < words; w++) {
+		for (uint64_t bits = P[w] | X[w]; bits; bits &= bits - 1) {
+			int u = w * 64 + __builtin_ctzll(bits), count = 0;
+			const uint64_t* r = row(u);
+			for (size_t i = 0; i < p_words; i++)
+				count += __builtin_popcountll(P[i] & r[i]);
+			if (count > most) {
+				most = count;
+				pivot = u;
+			}
+		}
 	}
 
-	return MIS(X);
-}
-
-// Returns the maximum independent set including only X vertices
-std::set<int> MIS(std::set<int> X) {
-	std::set<int> result;
-
-	if (X.empty())
-		return result;
+	// P is in its first p_words words, and so are the candidates
+	const uint64_t* pivot_row = row(pivot);
+	uint64_t* next_P = X + words;
+	uint64_t* next_X = next_P + words;
+	for (size_t w = 0; w < p_words; w++) {
+		// Branches only take bits of this word out of P
+		for (uint64_t bits = P[w] & ~pivot_row[w]; bits; bits &= bits - 1) {
+			int u = w * 64 + __builtin_ctzll(bits);
+			const uint64_t* r = row(u);
+			for (size_t i = 0; i < words; i++) {
+				next_P[i] = P[i] & r[i];
+				next_X[i] = X[i] & r[i];
+			}
 
-	// We can unite maximum independent sets
-	// of disconnected components 
-	std::vector<std::set<int>> components = connected_components(X);
-	if (components.size() > 1) {
-		for (auto i = components.begin(); i != components.end(); i++)
-			result = set_U(result, MIS(*i));
+			clique.push_back(local[u]);
+			expand(depth + 1);
+			clique.pop_back();
 
-		return result;
+			P[w] &= ~(bits & -bits);
+			X[w] |= bits & -bits;
+		}
 	}
+}
 
-	if (X.size() <= 2) {
-		return { *X.begin() };
+// Lists the maximal cliques of G, the graph of mis, with threads threads
+// that take the vertices of the degeneracy ordering one at a time,
+// and calls report(thread, clique) from the thread that finds each one
+// Returns the number of maximal cliques
+long long CliqueSearch::maximal_cliques(int threads, const CliqueReport& report) {
+	mis.swap_graph(graph);
+	core_decomposition();
+
+	int n = graph.size();
+	std::atomic<int> next(0);
+	std::vector<long long> found(threads, 0);
+	auto worker = [&](int t) {
+		CliqueLister lister(t, report, graph, rank_of);
+		for (int i = next++; i < n; i = next++)
+			lister.list(degeneracy_order[i]);
+		found[t] = lister.found;
+	};
+
+	std::vector<std::thread> pool;
+	for (int t = 1; t < threads; t++)
+		pool.emplace_back(worker, t);
+	worker(0);
+	for (auto& th : pool)
+		th.join();
+
+	mis.swap_graph(graph);
+	graph.clear();
+
+	long long total = 0;
+	for (long long f : found)
+		total += f;
+	return total;
+}
+
+// Writes the maximal cliques of G to path ("-" for stdout), one per line,
+// and prints how many there are
+// Each thread fills its own buffer and writes it when it is full,
+// so the memory doesn't grow with the number of cliques
+// Returns the exit code of the tool
+int CliqueSearch::write_maximal_cliques(const char* path, int threads) {
+	FILE* out = std::string(path) == "-" ? stdout : fopen(path, "w");
+	if (!out) {
+		std::cout << "Could not write " << path << "\n";
+		return 1;
 	}
 
-	std::map<int, int> deg = degrees(X);
-	std::vector<std::pair<int, int>> sorted_degrees; // We use vector of pair to sort the degree map
-	for (auto& it : deg)
-		sorted_degrees.push_back(it);
-	std::sort(sorted_degrees.begin(), sorted_degrees.end(), cmp_second);
-
-	// Picking the minimal degree vertex
-	int v = sorted_degrees[0].first;
-
-	// Picking the maximal degree neighboor of v
-	int u;
-	for (auto it = sorted_degrees.rbegin(); it != sorted_degrees.rend(); it++) {
-		u = (*it).first;
-		if (edge(v, u))
-			break;
+	std::mutex lock;
+	std::vector<std::string> buffers(threads);
+	auto flush = [&](std::string& buffer) {
+		std::lock_guard<std::mutex> guard(lock);
+		fwrite(buffer.data(), 1, buffer.size(), out);
+		buffer.clear();
+	};
+
+	long long count = maximal_cliques(threads, [&](int t, const std::vector<int>& clique) {
+		std::string& buffer = buffers[t];
+		for (size_t k = 0; k < clique.size(); k++) {
+			if (k)
+				buffer += ' ';
+			buffer += std::to_string(mis.input_vertex(clique[k]));
+		}
+		buffer += '\n';
+		if (buffer.size() >= (1 << 16))
+			flush(buffer);
+	});
+	for (auto& buffer : buffers)
+		flush(buffer);
+
+	if (out != stdout && fclose(out)) {
+		std::cout << "Could not write " << path << "\n";
+		return 1;
 	}
+	fflush(stdout);
+	std::cout << "Maximal cliques = " << count << "\n";
 
-	if (deg[v] == 1)
-		return set_U({ v }, MIS(set_M(X, N_C(v, X))));
+	return 0;
+}
 
-	if (deg[v] == 2) {
-		int u2 = *(set_M(N(v, X), { u }).begin());
-		if (edge(u, u2))
-			return set_U({ v }, MIS(set_M(X, N_C(v, X))));
+// Takes the options of the clique tool out of argv:
+// "--maximal FILE" lists all the maximal cliques in FILE ("-" for stdout)
+// instead of searching the maximum one, with "--threads N" threads
+// Returns the number of arguments left
+int CliqueSearch::clique_options(int argc, char* argv[]) {
+	int left = 1;
+	for (int k = 1; k < argc; k++) {
+		std::string option = argv[k];
+		if (k + 1 < argc && option == "--maximal")
+			maximal_path = argv[++k];
+		else if (k + 1 < argc && option == "--threads")
+			clique_threads = atoi(argv[++k]);
 		else
-			return bigst_set(set_U({ u, u2 }, MIS(set_M(X, set_U(N_C(u, X), N_C(u2, X))))), set_U({ v }, MIS2(set_M(X, N_C(v, X)), N2(v, X))));
+			argv[left++] = argv[k];
 	}
 
-	if (deg[v] == 3)
-		return bigst_set(MIS2(set_M(X, { v }), N(v, X)), set_U({ v }, MIS(set_M(X, N_C(v, X)))));
-
-	if (dominates(v, u, X))
-		return MIS(set_M(X, { u }));
-
-	return bigst_set(MIS(set_M(X, { u })), set_U({ u }, MIS(set_M(X, N_C(u, X)))));
+	return left;
 }
 
-// Input the number of vertices and adjacency matrix
+#ifndef NO_MAIN
+// Input the number of vertices and adjacency matrix,
+// or the path of a binary CSR file as argument,
+// or "--dimacs", "--metis", "--mtx" or "--snap" and the path of a file
+// Long searches can be saved with "--checkpoint FILE [--interval SECONDS]"
+// and continued with "--resume FILE"
+// With "--time-limit MILLISECONDS" or "--node-limit NODES" it prints each
+// better set it finds and, at the limit, the best one and an upper bound
+// "--local-search MILLISECONDS" prints the best set of a local search
+// and an upper bound, and "--warm-start MILLISECONDS" seeds the search with it
+// "--symmetry DEPTH" branches on orbits of automorphisms near the root
+// "--maximal FILE [--threads N]" writes all the maximal cliques to FILE
+// "--relabel degree|rcm|bfs" renumbers the vertices first, and the
+// cliques are printed with the input numbers
 // Prints the maximum clique
-int main() {
-	std::cin >> N_vertices;
-
-	for (int i = 0; i < N_vertices; i++)
-		for (int j = 0; j < N_vertices; j++)
-			std::cin >> mat[i][j];
-	
-	// Building the set of vertices
-	std::set<int> X;
-	for (int i = 0; i < N_vertices; i++)
-		X.insert(i);
-
-	complement_graph(); // Now we are working with !G
+int main(int argc, char* argv[]) {
+	CliqueSearch search;
+	argc = relabel_options(argc, argv, search.mis.relabel_method);
+	argc = search.clique_options(argc, argv);
+	argc = search.mis.search_options(argc, argv);
+	if (!search.mis.load_input(argc, argv))
+		return 1;
+
+	if (!search.maximal_path.empty()) {
+		int threads = search.clique_threads > 0 ? search.clique_threads : std::max(1u, std::thread::hardware_concurrency());
+		return search.write_maximal_cliques(search.maximal_path.c_str(), threads);
+	}
 
 	// The Maximum Independent Set of !G is the
 	// maximum clique of G
-	std::set<int> max_set = MIS(X); 
+	std::set<int> max_set = search.maximum_clique();
+	if (!search.mis.search_finished && !search.mis.search_limited)
+		return 2;
+	max_set = search.mis.input_set(max_set);
 
 	// Printing the maximum clique
-	std::cout << "Maximum Clique = {";
+	std::cout << (search.mis.search_limited ? "Best Clique = {" : "Maximum Clique = {");
 	for (auto it = max_set.begin(); it != std::prev(max_set.end()); it++)
 		std::cout << *it << ", ";
 	if (!max_set.empty())
 		std::cout << *(max_set.rbegin());
 	std::cout << "}\n";
+	if (search.mis.search_limited)
+		std::cout << "Upper bound = " << search.mis.search_bound << "\n";
+
+#ifdef MIS_STATS
+	search.mis.print_stats(std::cerr);
+#endif
 
 	return 0;
 }
+#endif
@@ -3,420 +3,2705 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <random>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <list>
+#include <unordered_map>
+#include <memory>
+
+#include "graph_csr.h"
+#include "graph_formats.h"
+#include "graph_relabel.h"
+#include "graph_compressed.h"
+
+// The LP reduction solves its matchings with the Blossom of the matching tool
+namespace matching {
+#ifdef NO_MAIN
+#include "maximum_matching.cpp"
+#else
+#define NO_MAIN
+#include "maximum_matching.cpp"
+#undef NO_MAIN
+#endif
+}
 
-//Global variables
-int mat[100][100];
-
-int N_vertices;
-
-// Declarations
-int find(std::vector<int>& parent, int i);
-void unite(std::vector<int>& parent, int x, int y);
-bool edge(int i, int j);
-std::set<int> bigst_set(std::set<int> A, std::set<int> B);
-std::set<int> set_U(std::set<int> A, std::set<int> B);
-std::set<int> set_M(std::set<int> A, std::set<int> B);
-std::set<int> set_I(std::set<int> A, std::set<int> B);
-bool set_S(std::set<int> A, std::set<int> B);
-std::vector<std::set<int>> connected_components(std::set<int> vertices);
-std::map<int, int> degrees(std::set<int> X);
-bool cmp_second(std::pair<int, int> a, std::pair<int, int> b);
-std::set<int> N(int v, std::set<int> X);
-std::set<int> N_C(int v, std::set<int> X);
-std::set<int> N2(int v, std::set<int> X);
-bool dominates(int v, int u, std::set<int> X);
-std::set<int> MIS1(std::set<int> X, std::set<int> S);
-std::set<int> MIS2(std::set<int> X, std::set<int> S);
-std::set<int> MIS(std::set<int> X);
+// Stack of ints for the scratch space of the search nodes
+// A node takes space with take and gives it back when it returns,
+// so after the first nodes the search makes no allocations
+// Positions are used instead of pointers, since data may grow
+// The lists are taken at their biggest size and cut to the size they got
+// A branching node keeps lists of vertices its branches remove, or of
+// their neighbors, and a vertex is removed once in a path of the search
+// tree, so these take O(n + m) ints along the path. A components node
+// keeps only the bounds of its components, whose vertices are grouped in
+// place in component_order, and each component but the one searched is
+// disjoint from the nodes below it, so the bounds take O(n + depth) ints
+// The peak is O(n + m) ints, plus O(1) for each node of the path
+struct Arena {
+	std::vector<int> data;
+	size_t top = 0;
+
+	size_t take(size_t k) {
+		if (top + k > data.size())
+			data.resize(std::max(2 * data.size(), top + k));
+		top += k;
+		return top - k;
+	}
 
+	void release(size_t point) {
+		top = point;
+	}
 
+	int& operator[](size_t i) {
+		return data[i];
+	}
+};
+
+// Functions of the search, each node of the search tree runs one of them
+enum Search { SEARCH_MIS, SEARCH_MIS1, SEARCH_MIS2 };
+
+// Branch of a node of the search tree: removes vertices from X,
+// searches a child node and adds vertices to the set the child found
+struct Branch {
+	int search; // Function of the child
+	size_t S; // Set S of the child (MIS1 and MIS2) in the scratch space
+	int S_size;
+	int closed[3]; // Vertices removed with their neighboors
+	int n_closed;
+	int dropped; // Vertex removed alone, or -1
+	size_t R; // List of vertices removed in the scratch space
+	int R_size;
+	int added[3]; // Vertices added after the child returns
+	int n_added;
+
+	Branch(int search = SEARCH_MIS, size_t S = 0, int S_size = 0)
+		: search(search), S(S), S_size(S_size), n_closed(0), dropped(-1), R(0), R_size(0), n_added(0) {}
+
+	Branch& close(int v) {
+		closed[n_closed++] = v;
+		return *this;
+	}
 
-//Definitions
+	Branch& drop(int v) {
+		dropped = v;
+		return *this;
+	}
 
-// Implementation of union-find algorithm
+	Branch& drop(size_t list, int size) {
+		R = list;
+		R_size = size;
+		return *this;
+	}
 
-// Find function:
-int find(std::vector <int> &parent, int i){
-	if (parent[i] == i)
-		return i;
-	return find(parent, parent[i]);
+	Branch& add(int v) {
+		added[n_added++] = v;
+		return *this;
+	}
+};
+
+// Node of the search tree in the explicit stack
+// It decides its rule when it is expanded, which gives its branches,
+// and its children are searched one at a time
+// A node of the components rule has one branch for each component instead
+struct Frame {
+	int search; // Function of the node
+	size_t S; // Set S of the node (MIS1 and MIS2) in the scratch space
+	int S_size;
+	size_t base; // Start of the set of the node in the solution stack
+	size_t mid; // End of the set of the first branch
+	size_t point; // Size of the undo log when the node started
+	size_t top; // Top of the scratch space when the node started
+	int branches; // Number of branches, -1 until the node is expanded
+	int next; // Next branch to search
+	bool components; // The branches are the components in B
+	size_t L; // X is in component_order from L on
+	size_t B; // Bounds of the components, from L, in the scratch space
+	int committed; // Vertices the ancestors add to the set of the node
+	int pending; // Vertices of the components the ancestors search after it
+	bool pruned; // A node of its subtree was pruned, so its set may not be maximum
+	long long first_node; // Nodes expanded before it
+	Branch branch[2];
+};
+
+// Checkpoints
+// The search state is plain data (X, the undo log, the solution stack,
+// the component lists, the scratch space and the frames), so a checkpoint
+// is a copy of it
+#define CHECKPOINT_MAGIC "MISCKPT4"
+
+struct CheckpointHeader {
+	char magic[8];
+	uint64_t n, hash; // The graph it belongs to
+	uint64_t frame_size; // Frames are written as they are in memory
+	int64_t alive;
+	uint64_t removed, solution, scratch, frames, incumbent; // Sizes of each part
+};
+
+volatile std::sig_atomic_t stop_requested = 0; // Set by request_stop
+
+// LP reduction
+// The LP relaxation of vertex cover has a half-integral optimum given by a
+// maximum matching of the bipartite double cover of X, which has a left and
+// a right copy of each vertex and the edges u_L w_R and w_L u_R for each
+// edge uw: by Konig's theorem, a minimum vertex cover C of the double cover
+// gives x_v = ([v_L in C] + [v_R in C]) / 2
+// By Nemhauser and Trotter some maximum independent set has every vertex
+// with x_v = 0 and none with x_v = 1, so the search starts with the
+// vertices with x_v = 1/2 only, and X has no independent set bigger
+// than |X| - nu / 2, where nu is the size of the matching
+#define LP_LIMIT 8192 // Biggest X for the Blossom, which keeps a matrix of the edges
+
+// Transposition table
+// Different branches often reach the same X, so the sets of MIS nodes are
+// kept in a table keyed by a Zobrist hash of X: the xor of a random key of
+// each of its vertices, kept up to date as vertices leave X and come back,
+// with a second hash to check the entries
+// Nodes pruned with the incumbent keep their bound instead, and subtrees
+// with pruned nodes keep nothing, since their sets may be too small
+// When the table goes over its memory budget the least recently used
+// entries are evicted
+#define CACHE_MIN_VERTICES 16 // Smaller nodes are faster to search again
+#define CACHE_MIN_NODES 64 // Only sets that took this many nodes are kept
+
+struct CacheEntry {
+	uint64_t check; // Second hash of X
+	int vertices; // Size of X
+	bool exact; // set is a maximum independent set of X, or else value is a bound
+	int value;
+	std::vector<int> set;
+};
+
+// Table of the sets of X
+// Each search has its own table (see MisSearch), so it takes no locks
+class TranspositionTable {
+	typedef std::list<std::pair<uint64_t, CacheEntry>> Entries;
+
+	Entries entries; // Most recently used first
+	std::unordered_map<uint64_t, Entries::iterator> index;
+	size_t bytes = 0, budget = 0;
+
+	static size_t size_of(const CacheEntry& e) {
+		return sizeof(CacheEntry) + 64 + e.set.size() * sizeof(int);
+	}
+
+public:
+	long long lookups = 0, hits = 0;
+
+	// Empties the table and sets its budget, in bytes
+	void reset(size_t budget) {
+		entries.clear();
+		index.clear();
+		bytes = 0;
+		this->budget = budget;
+		lookups = hits = 0;
+	}
+
+	bool enabled() {
+		return budget > 0;
+	}
+
+	// Copies the entry of X to out and marks it as used
+	// Returns false if X has no entry
+	bool find(uint64_t key, uint64_t check, int vertices, CacheEntry& out) {
+		lookups++;
+		auto it = index.find(key);
+		if (it == index.end() || it->second->second.check != check || it->second->second.vertices != vertices)
+			return false;
+
+		entries.splice(entries.begin(), entries, it->second);
+		out = it->second->second;
+		hits++;
+		return true;
+	}
+
+	// Keeps the set or bound of X, unless X has a better entry already
+	void store(uint64_t key, const CacheEntry& e) {
+		auto it = index.find(key);
+		if (it != index.end()) {
+			CacheEntry& old = it->second->second;
+			if (old.check == e.check && old.vertices == e.vertices && (old.exact || (!e.exact && old.value <= e.value)))
+				return;
+			bytes -= size_of(old);
+			entries.erase(it->second);
+			index.erase(it);
+		}
+
+		entries.emplace_front(key, e);
+		index[key] = entries.begin();
+		bytes += size_of(e);
+		while (bytes > budget && !entries.empty()) {
+			bytes -= size_of(entries.back().second);
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+	}
+};
+
+
+// Symmetry
+// Vertices in the same orbit of the automorphisms of G[X] are interchangeable,
+// so a node can branch on u in or its whole orbit out (orbital branching,
+// Ostrowski et al.): an automorphism maps a maximum independent set with a
+// vertex of the orbit to one with u
+// w is in the orbit of u if color refinement, with u and w individualized
+// and then one vertex of each class at a time, ends with two discrete
+// colorings that match as an automorphism. A search that takes too long
+// leaves w out, which keeps the branching right
+#define SYMMETRY_LIMIT 256 // Colorings tried by each search of an automorphism
+
+// Small subproblems
+// MIS nodes with at most bitset_limit vertices are solved at once with bitsets
+// of 64, 128, 256 or 512 bits, the smallest that fits X, so the sets of the
+// smallest ones are single words in registers and none of them use the heap
+// They still go through the table, the pruning, the components and the
+// rules that need no branching first, and only replace the branching rules
+// Up to TABLE_VERTICES vertices the set is in a table indexed by the bits
+// of their adjacency, each entry filled the first time it is used
+#define BITSET_LIMIT 512
+#define TABLE_VERTICES 6
+
+// Maximum independent set of each graph of TABLE_VERTICES vertices,
+// as a mask, by the bits of its adjacency (i, j) with i < j in order
+// Building all of it takes longer than solving most inputs, so each entry
+// is filled when it is first used, 0 until then (no set is empty)
+struct SmallTable {
+	uint8_t best[1 << (TABLE_VERTICES * (TABLE_VERTICES - 1) / 2)] = {};
+
+	uint8_t get(unsigned bits) {
+		if (best[bits])
+			return best[bits];
+
+		unsigned nb[TABLE_VERTICES] = {};
+		for (int i = 0, b = 0; i < TABLE_VERTICES; i++)
+			for (int j = i + 1; j < TABLE_VERTICES; j++, b++)
+				if (bits >> b & 1) {
+					nb[i] |= 1u << j;
+					nb[j] |= 1u << i;
+				}
+
+		// s is independent if s without its lowest vertex v is and
+		// v has no neighbor in s, so each set takes one test
+		bool independent[1 << TABLE_VERTICES];
+		independent[0] = true;
+		for (unsigned s = 1; s < (1u << TABLE_VERTICES); s++) {
+			int v = __builtin_ctz(s);
+			independent[s] = independent[s & (s - 1)] && !(nb[v] & s);
+			if (independent[s] && __builtin_popcount(s) > __builtin_popcount(best[bits]))
+				best[bits] = s;
+		}
+		return best[bits];
+	}
+};
+
+// Set of up to 64 * W vertices, the loops over the words have a
+// fixed length so they are unrolled
+template <int W>
+struct VertexSet {
+	uint64_t word[W];
+
+	static VertexSet none() {
+		VertexSet s;
+		for (int i = 0; i < W; i++)
+			s.word[i] = 0;
+		return s;
+	}
+
+	// The vertices from 0 to n - 1
+	static VertexSet first(int n) {
+		VertexSet s;
+		for (int i = 0; i < W; i++)
+			s.word[i] = n >= 64 * (i + 1) ? ~0ULL : n <= 64 * i ? 0 : (1ULL << (n - 64 * i)) - 1;
+		return s;
+	}
+
+	bool empty() const {
+		uint64_t any = 0;
+		for (int i = 0; i < W; i++)
+			any |= word[i];
+		return !any;
+	}
+
+	int size() const {
+		int count = 0;
+		for (int i = 0; i < W; i++)
+			count += __builtin_popcountll(word[i]);
+		return count;
+	}
+
+	// The lowest vertex, the set can't be empty
+	int lowest() const {
+		int i = 0;
+		while (!word[i])
+			i++;
+		return 64 * i + __builtin_ctzll(word[i]);
+	}
+
+	bool has(int v) const {
+		return word[v >> 6] >> (v & 63) & 1;
+	}
+
+	void add(int v) {
+		word[v >> 6] |= 1ULL << (v & 63);
+	}
+
+	void remove(int v) {
+		word[v >> 6] &= ~(1ULL << (v & 63));
+	}
+
+	VertexSet operator&(const VertexSet& o) const {
+		VertexSet s;
+		for (int i = 0; i < W; i++)
+			s.word[i] = word[i] & o.word[i];
+		return s;
+	}
+
+	VertexSet operator|(const VertexSet& o) const {
+		VertexSet s;
+		for (int i = 0; i < W; i++)
+			s.word[i] = word[i] | o.word[i];
+		return s;
+	}
+
+	VertexSet without(const VertexSet& o) const {
+		VertexSet s;
+		for (int i = 0; i < W; i++)
+			s.word[i] = word[i] & ~o.word[i];
+		return s;
+	}
+
+	bool operator==(const VertexSet& o) const {
+		uint64_t diff = 0;
+		for (int i = 0; i < W; i++)
+			diff |= word[i] ^ o.word[i];
+		return !diff;
+	}
+
+	// Calls f(v) for each vertex v in increasing order
+	template <typename F>
+	void for_each(F f) const {
+		for (int i = 0; i < W; i++)
+			for (uint64_t m = word[i]; m; m &= m - 1)
+				f(64 * i + __builtin_ctzll(m));
+	}
+};
+
+// Branch and bound for the maximum independent set of a graph of up to
+// 64 * W vertices, where nb[v] are the neighbors of v
+// Vertices of degree 0 or 1 are taken, components are searched apart,
+// a greedy clique cover bounds each set and the vertex of maximal degree
+// is left out first, then taken
+template <int W>
+struct BitsetSearch {
+	VertexSet<W> nb[64 * W];
+	SmallTable* table; // Of the search that owns it
+
+	// Greedy clique cover of P, each clique has at most one vertex of a set
+	int cover(VertexSet<W> P) const {
+		int cliques = 0;
+		while (!P.empty()) {
+			int v = P.lowest();
+			P.remove(v);
+			VertexSet<W> candidates = nb[v] & P;
+			while (!candidates.empty()) {
+				int u = candidates.lowest();
+				P.remove(u);
+				candidates = candidates & nb[u];
+			}
+			cliques++;
+		}
+		return cliques;
+	}
+
+	// The set of the first component of P
+	VertexSet<W> component(const VertexSet<W>& P) const {
+		VertexSet<W> C = VertexSet<W>::none(), frontier = C;
+		frontier.add(P.lowest());
+		while (!frontier.empty()) {
+			C = C | frontier;
+			VertexSet<W> next = VertexSet<W>::none();
+			frontier.for_each([&](int v) {
+				next = next | nb[v];
+			});
+			frontier = (next & P).without(C);
+		}
+		return C;
+	}
+
+	// Maximum independent set of at most TABLE_VERTICES vertices
+	VertexSet<W> table_set(const VertexSet<W>& P) const {
+		// Missing vertices of the table are isolated, so they are
+		// in its set and are taken out after
+		int vertex[TABLE_VERTICES], k = 0;
+		P.for_each([&](int v) {
+			vertex[k++] = v;
+		});
+		unsigned bits = 0;
+		for (int i = 0, b = 0; i < TABLE_VERTICES; i++)
+			for (int j = i + 1; j < TABLE_VERTICES; j++, b++)
+				if (j < k && nb[vertex[i]].has(vertex[j]))
+					bits |= 1u << b;
+
+		VertexSet<W> set = VertexSet<W>::none();
+		unsigned best = table->get(bits);
+		for (int i = 0; i < k; i++)
+			if (best >> i & 1)
+				set.add(vertex[i]);
+		return set;
+	}
+
+	// Puts in set a maximum independent set of P if it has more than lower
+	// vertices and returns its size, or returns a size up to lower if not
+	int solve(VertexSet<W> P, int lower, VertexSet<W>& set) const {
+		set = VertexSet<W>::none();
+		int taken = 0, v;
+
+		// Vertices of degree 0 or 1 are in a maximum independent set
+		bool reduced;
+		do {
+			reduced = false;
+			int most = -1;
+			v = -1;
+			P.for_each([&](int w) {
+				if (!P.has(w))
+					return;
+				int d = (nb[w] & P).size();
+				if (d <= 1) {
+					set.add(w);
+					P = P.without(nb[w]);
+					P.remove(w);
+					taken++;
+					reduced = true;
+				}
+				else if (d > most) {
+					most = d;
+					v = w;
+				}
+			});
+		} while (reduced);
+
+		lower -= taken;
+		if (P.empty())
+			return taken;
+		if (P.size() <= TABLE_VERTICES) {
+			set = set | table_set(P);
+			return set.size();
+		}
+
+		VertexSet<W> C = component(P), sub;
+		if (!(C == P)) {
+			// Each component can fail only if the other can't make up for it
+			VertexSet<W> rest = P.without(C);
+			int found = solve(C, lower - cover(rest), sub);
+			if (found <= lower - cover(rest))
+				return taken + lower;
+			set = set | sub;
+			int found_rest = solve(rest, lower - found, sub);
+			if (found_rest <= lower - found)
+				return taken + lower;
+			set = set | sub;
+			return taken + found + found_rest;
+		}
+
+		if (cover(P) <= lower)
+			return taken + lower;
+
+		VertexSet<W> best = VertexSet<W>::none();
+		bool better = false;
+
+		P.remove(v);
+		int found = solve(P, lower, sub);
+		if (found > lower) {
+			lower = found;
+			best = sub;
+			better = true;
+		}
+
+		found = solve(P.without(nb[v]), lower - 1, sub) + 1;
+		if (found > lower) {
+			lower = found;
+			best = sub;
+			best.add(v);
+			better = true;
+		}
+
+		if (better)
+			set = set | best;
+		return taken + lower;
+	}
+};
+
+
+
+// Search statistics, compiled only with -DMIS_STATS
+// Counts the nodes of the search tree by function and by depth,
+// the rule that decided each node and the time spent in
+// connected_components and lowest_degrees
+// Prints a progress line to stderr every second of search
+#ifdef MIS_STATS
+enum Rule {
+	BITSET, MIS_EMPTY, MIS_COMPONENTS, MIS_SMALL, MIS_DEG1, MIS_DEG2_FOLD, MIS_DEG2_BRANCH,
+	MIS_DEG3, MIS_DOMINATION, MIS_ORBIT, MIS_BRANCH,
+	MIS1_LOW_DEGREE, MIS1_ADJACENT_LOW, MIS1_ADJACENT_BRANCH, MIS1_COMMON_NEIGHBORS,
+	MIS1_DEG2_TRIANGLE, MIS1_DEG2_COVER, MIS1_DEG2_BRANCH, MIS1_BRANCH,
+	MIS2_SIZE_1, MIS2_SIZE_2_ADJACENT, MIS2_SIZE_2, MIS2_SIZE_3_ISOLATED, MIS2_SIZE_3_TRIANGLE,
+	MIS2_SIZE_3_TWO_EDGES, MIS2_SIZE_3_ONE_EDGE, MIS2_SIZE_3_COMMON_NEIGHBOR,
+	MIS2_SIZE_3_DEG1, MIS2_SIZE_3_BRANCH, MIS2_SIZE_4_LOW, MIS2_SIZE_4_BRANCH, MIS2_SIZE_BIG,
+	PRUNED, LP_PRUNED, CACHED, CACHED_BOUND,
+	N_RULES
+};
+
+const char* rule_names[N_RULES] = {
+	"BITSET", "MIS_EMPTY", "MIS_COMPONENTS", "MIS_SMALL", "MIS_DEG1", "MIS_DEG2_FOLD", "MIS_DEG2_BRANCH",
+	"MIS_DEG3", "MIS_DOMINATION", "MIS_ORBIT", "MIS_BRANCH",
+	"MIS1_LOW_DEGREE", "MIS1_ADJACENT_LOW", "MIS1_ADJACENT_BRANCH", "MIS1_COMMON_NEIGHBORS",
+	"MIS1_DEG2_TRIANGLE", "MIS1_DEG2_COVER", "MIS1_DEG2_BRANCH", "MIS1_BRANCH",
+	"MIS2_SIZE_1", "MIS2_SIZE_2_ADJACENT", "MIS2_SIZE_2", "MIS2_SIZE_3_ISOLATED", "MIS2_SIZE_3_TRIANGLE",
+	"MIS2_SIZE_3_TWO_EDGES", "MIS2_SIZE_3_ONE_EDGE", "MIS2_SIZE_3_COMMON_NEIGHBOR",
+	"MIS2_SIZE_3_DEG1", "MIS2_SIZE_3_BRANCH", "MIS2_SIZE_4_LOW", "MIS2_SIZE_4_BRANCH", "MIS2_SIZE_BIG",
+	"PRUNED", "LP_PRUNED", "CACHED", "CACHED_BOUND"
+};
+
+struct SearchStats {
+	long long nodes[3] = {0, 0, 0}; // Calls of MIS, MIS1 and MIS2
+	long long rules[N_RULES] = {};
+	std::vector<long long> depth_nodes; // depth_nodes[d] is the number of nodes at depth d
+	double components_time = 0, degrees_time = 0; // In seconds
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point last_progress = start;
+};
+
+// Adds the time it is alive to total
+struct StatTimer {
+	double& total;
+	std::chrono::steady_clock::time_point start;
+
+	StatTimer(double& total) : total(total), start(std::chrono::steady_clock::now()) {}
+
+	~StatTimer() {
+		total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+};
+
+#endif
+
+// State of the search of one graph at a time, so each thread or program
+// that embeds the search keeps its own and they share nothing
+// The buffers are kept from one search to the next (see solver_api.h)
+// Its options are set before MIS and its results are read after it,
+// the rest belongs to the search
+class MisSearch {
+	// Graph
+	// The graph is kept as adjacency lists, so it takes O(n + m) memory
+	std::vector<std::vector<int>> adj; // Sorted neighboors of each vertex, no loops
+	std::vector<int> input_id; // Number in the input of each vertex, if relabeled
+
+	// Search state
+	// The search works on a single copy of the vertex set X: its vertices are
+	// order[0, alive), in any order, and pos[v] is the position of v in order
+	// A vertex is removed by swapping it to the end of X and is logged
+	// in removed, so a branch restores X by undoing the log back to where it
+	// started (restore), in reverse order
+	std::vector<int> order, pos;
+	int alive = 0; // Size of X
+	std::vector<int> deg; // Degree of each vertex of X in X
+	std::vector<int> removed; // Undo log
+	std::vector<int> solution; // Each search appends the set it finds here
+	std::vector<unsigned> seen; // Vertices marked with the current stamp
+	unsigned stamp = 0;
+	Arena scratch;
+
+	// Vertices grouped by component for the components nodes, and the position
+	// of each one: a node groups X inside the range of the component of its
+	// nearest components ancestor, which holds all of X, so it only permutes
+	// that range and the components of its ancestors keep their vertices
+	std::vector<int> component_order, component_pos;
+
+	std::vector<Frame> frames; // Nodes of the search tree from the root to the current one
+
+	// Anytime search, see node_limit and time_limit
+	// The search keeps the best independent set it has seen (the incumbent)
+	std::vector<int> incumbent, candidate;
+	std::vector<int> by_degree; // Vertices of X sorted by degree in the graph
+	std::chrono::steady_clock::time_point search_start;
+
+	// Local search
+	// Iterated local search in the style of Andrade, Resende and Werneck:
+	// the solution is improved with (1,2)-swaps, which take a vertex out and
+	// put two in, until there are none, and then perturbed by forcing random
+	// vertices into it. tight[v] is the number of neighbors of v in the
+	// solution, so the free vertices (tight 0) go in as they are and the
+	// vertices a swap of x puts in are neighbors of x with tight 1
+	// Its best solution becomes the incumbent, and the exact search
+	// prunes the nodes that can't beat the incumbent
+	std::vector<int> members, member_pos; // The solution, member_pos[v] is -1 if v is out of it
+	std::vector<int> tight;
+	std::vector<int> free_list, free_pos; // Free vertices of X, free_pos[v] is -1 if v isn't free
+	std::vector<int> swap_queue; // Vertices of the solution to try swaps on
+	std::vector<char> queued;
+	std::vector<int> moves; // Moves of the current iteration: v + 1 in, -(v + 1) out
+	bool logging_moves = false;
+	int forced = 0; // Vertex forced in by the perturbation, no swap takes it out
+	std::mt19937 local_rng{2022};
+
+	// LP reduction, see lp_reduce
+	std::vector<int> forced_in; // Vertices the LP reduction put in the solution
+	int lp_root_bound = 0; // Bound of the graph given by the LP at the root
+	std::vector<int> lp_index; // Position of each vertex in X for the double cover
+	std::vector<int> lp_value; // 2 * x_v of each vertex of X, by position
+	std::vector<char> lp_reached; // Vertices of the double cover reached from free left vertices
+	matching::Blossom lp_blossom{0};
+
+	// Transposition table, see TranspositionTable
+	TranspositionTable cache; // Of this search only
+	std::vector<uint64_t> zobrist_key, zobrist_check; // Random keys of each vertex
+	uint64_t x_key = 0, x_check = 0; // Hashes of X
+
+	// Symmetry, see orbit_of
+	std::vector<std::vector<int>> sym_adj; // Lists of G[X] by position in X
+
+	// Small subproblems, see BitsetSearch
+	int small_limit = 0; // bitset_limit of the current search, see run_search
+	std::unique_ptr<SmallTable> table; // Allocated by the first search that needs it
+	std::unique_ptr<BitsetSearch<1>> bitset1;
+	std::unique_ptr<BitsetSearch<2>> bitset2;
+	std::unique_ptr<BitsetSearch<4>> bitset4;
+	std::unique_ptr<BitsetSearch<8>> bitset8;
+
+#ifdef MIS_STATS
+	SearchStats stats;
+
+	void stat_node(int f, int depth);
+#endif
+
+	// Declarations
+	bool edge(int i, int j);
+	bool load_csr(const char* path);
+	bool load_format(const char* format, const char* path);
+	bool relabel_input();
+	void start_search(const std::set<int>& X);
+	bool in_X(int v);
+	int degree(int v);
+	void new_stamp();
+	void remove_vertex(int v);
+	void remove_closed(int v);
+	void restore(size_t point);
+	int keep_biggest(size_t base, size_t mid);
+	int connected_components(size_t L, size_t& B);
+	int lowest_degrees(const int* list, int size, int low[], int k);
+	int neighbors_in_X(int v, size_t& S);
+	int second_neighbors(int v, size_t& S);
+	int common_neighbors(int a, int b, size_t& C);
+	int set_without(size_t S, int S_size, int v, size_t& R);
+	size_t pair_set(int a, int b);
+	bool dominates(int v, int u);
+	bool covers(int e, int f, int s1, int s2);
+	void push_frame(int search, size_t S, int S_size, int committed, int pending);
+	void plan(Frame& f);
+	void plan(Frame& f, const Branch& a);
+	void plan(Frame& f, const Branch& a, const Branch& b);
+	void expand_MIS(Frame& f);
+	void expand_MIS1(Frame& f);
+	void expand_MIS2(Frame& f);
+	void remove_branch(const Branch& br);
+	void start_branch(Frame& f);
+	void finish_branch(Frame& f);
+	bool limit_reached(long long expanded);
+	void update_incumbent(size_t depth, bool finished);
+	int clique_cover_bound();
+	int search_upper_bound();
+	void set_free(int v, bool free);
+	void queue_swap(int x);
+	void put_in(int v);
+	void take_out(int v);
+	bool try_swap(int x);
+	void descend();
+	void undo_moves();
+	void perturb(int k);
+	std::vector<int> local_search(double time_ms);
+	int lp_solve();
+	int lp_bound();
+	void lp_reduce();
+	void hash_X();
+	bool cache_lookup(Frame& f);
+	void cache_bound(int value);
+	void cache_store(const Frame& f, long long nodes);
+	bool can_improve(const Frame& f);
+	int refine(std::vector<int>& color, int colors);
+	bool automorphism(std::vector<int> a, std::vector<int> b, int colors, int& budget, std::vector<int>& map);
+	int orbit_of(int u, size_t& O);
+	template <int W>
+	void solve_bitset(std::unique_ptr<BitsetSearch<W>>& search);
+	void solve_small();
+	bool run_search();
+	uint64_t graph_hash();
+	bool save_checkpoint(const char* path);
+	bool load_checkpoint(const char* path);
+
+public:
+	int N_vertices = 0;
+	std::string relabel_method; // Relabeling of the input, empty for none
+
+	// Checkpoints, see CheckpointHeader
+	std::string checkpoint_path, resume_path;
+	double checkpoint_interval = 300; // In seconds
+
+	// Anytime search
+	// With a node or time limit the search keeps the best independent set
+	// it has seen and, when it stops at the limit, an upper bound of the
+	// maximum independent set
+	long long node_limit = 0; // Nodes expanded before stopping, 0 for no limit
+	double time_limit = 0; // Milliseconds before stopping, 0 for no limit
+
+	// Embedding
+	// Another thread stops the search by setting *cancel_flag, which is read
+	// at each node, and the search ends as it does at a limit
+	// search_progress is called every progress_interval milliseconds with the
+	// nodes expanded and the size of the best set found so far
+	// With either one the bitset nodes have at most 64 vertices, as with limits
+	const std::atomic<bool>* cancel_flag = NULL;
+	std::function<void(long long nodes, int best)> search_progress;
+	double progress_interval = 100;
+
+	double local_search_time = 0; // Milliseconds of local search alone, 0 for none
+	double warm_start_time = 0; // Milliseconds of local search before the exact search
+	bool lp_reduction = true; // See lp_reduce
+	double cache_mb = 64; // Memory budget of the transposition table, 0 turns it off
+	int symmetry_depth = 0; // Nodes above this depth branch on orbits, 0 for none
+	int bitset_limit = 128; // Vertices of the biggest subproblems solved with bitsets
+
+	// Results of the last search
+	bool search_finished = false; // false if it stopped to be resumed
+	bool search_limited = false; // The search stopped at a limit
+	bool search_cancelled = false; // The search stopped at cancel_flag
+	int search_bound = 0; // Upper bound when the search stops
+	long long search_nodes = 0; // Nodes expanded by the last search
+
+#ifdef MIS_STATS
+	void print_stats(std::ostream& out);
+#endif
+
+	// Declarations
+	void set_graph(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors);
+	void swap_graph(std::vector<std::vector<int>>& lists);
+	bool load_input(int argc, char* argv[]);
+	std::set<int> input_set(const std::set<int>& S);
+	int input_vertex(int v);
+	int search_options(int argc, char* argv[]);
+	std::set<int> MIS(std::set<int> X);
+};
+
+#ifdef MIS_STATS
+// Counts a node of the function f (0 for MIS, 1 for MIS1, 2 for MIS2)
+// at depth in the search tree
+void MisSearch::stat_node(int f, int depth) {
+	long long total = ++stats.nodes[f] + stats.nodes[(f + 1) % 3] + stats.nodes[(f + 2) % 3];
+	if ((int) stats.depth_nodes.size() <= depth)
+		stats.depth_nodes.resize(depth + 1);
+	stats.depth_nodes[depth]++;
+
+	// Looking at the clock only once in a while keeps the overhead low
+	if (total % 4096 == 0) {
+		auto now = std::chrono::steady_clock::now();
+		if (now - stats.last_progress >= std::chrono::seconds(1)) {
+			stats.last_progress = now;
+			std::cerr << "[MIS] " << total << " nodes, depth " << depth
+				<< ", max depth " << stats.depth_nodes.size() - 1 << ", "
+				<< std::chrono::duration<double>(now - stats.start).count() << " s\n";
+		}
+	}
 }
 
-// Union function:
-void unite(std::vector <int> &parent, int x, int y){
-	int xset = find(parent, x);
-	int yset = find(parent, y);
-	parent[yset] = xset;
+// Prints the statistics as JSON
+void MisSearch::print_stats(std::ostream& out) {
+	out << "{\"nodes\": {\"MIS\": " << stats.nodes[0] << ", \"MIS1\": " << stats.nodes[1]
+		<< ", \"MIS2\": " << stats.nodes[2] << "},\n \"rules\": {";
+	for (int r = 0; r < N_RULES; r++)
+		out << (r ? ", " : "") << "\"" << rule_names[r] << "\": " << stats.rules[r];
+	out << "},\n \"depth_nodes\": [";
+	for (size_t d = 0; d < stats.depth_nodes.size(); d++)
+		out << (d ? ", " : "") << stats.depth_nodes[d];
+	out << "],\n \"cache\": {\"lookups\": " << cache.lookups << ", \"hits\": " << cache.hits
+		<< ", \"hit_rate\": " << (cache.lookups ? (double) cache.hits / cache.lookups : 0.0)
+		<< "},\n \"components_time\": " << stats.components_time
+		<< ", \"degrees_time\": " << stats.degrees_time << ", \"total_time\": "
+		<< std::chrono::duration<double>(std::chrono::steady_clock::now() - stats.start).count() << "}\n";
 }
 
+#define STAT_NODE(f, depth) stat_node(f, depth)
+#define STAT_RULE(rule) stats.rules[rule]++
+#define STAT_TIME(total) StatTimer stat_timer(stats.total)
+#else
+#define STAT_NODE(f, depth)
+#define STAT_RULE(rule)
+#define STAT_TIME(total)
+#endif
+
+
+
+//Definitions
+
 // Returns true if there is an edge connecting i and j
 // Returns false otherwise
-bool edge(int i, int j) {
-	return mat[i][j];
+bool MisSearch::edge(int i, int j) {
+	return std::binary_search(adj[i].begin(), adj[i].end(), j);
 }
 
-// Returns the biggest set
-// Chooses the first in case of draw
-std::set<int> bigst_set(std::set<int> A, std::set<int> B) {
-	if (A.size() < B.size())
-		return B;
-	else
-		return A;
+// Copies the sorted lists of a CSR graph with n vertices, without loops
+void MisSearch::set_graph(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors) {
+	N_vertices = n;
+	adj.assign(N_vertices, std::vector<int>());
+	for (int v = 0; v < N_vertices; v++) {
+		adj[v].reserve(offsets[v + 1] - offsets[v]);
+		for (uint64_t k = offsets[v]; k < offsets[v + 1]; k++)
+			if ((int) neighbors[k] != v)
+				adj[v].push_back(neighbors[k]);
+	}
 }
 
-// Returns the union of two sets A U B
-std::set<int> set_U(std::set<int> A, std::set<int> B) {
-	std::set<int> result = A;
-	result.insert(B.begin(), B.end());
-	
-	return result;
+// Loads the graph of a binary CSR file (see graph_csr.h),
+// without parsing text
+// Returns false if the file can't be loaded
+bool MisSearch::load_csr(const char* path) {
+	csr_graph g;
+	if (csr_open(path, &g))
+		return false;
+
+	set_graph(g.n, g.offsets, g.neighbors);
+
+	csr_close(&g);
+	return true;
+}
+
+// Loads the graph of a file in one of the formats of graph_formats.h
+// Returns false if the file can't be loaded
+bool MisSearch::load_format(const char* format, const char* path) {
+	CsrGraph g;
+	if (!read_graph_file(format, path, g))
+		return false;
+
+	set_graph(g.n, g.offsets.data(), g.neighbors.data());
+	return true;
 }
 
-// Returns the difference of two sets A\B
-std::set<int> set_M(std::set<int> A, std::set<int> B) {
-	std::set<int> result = A;
-	for (auto& it : B) {
-		if (A.count(it))
-			result.erase(it);
+// Loads the graph given in the command line: the path of a binary CSR file,
+// or "--dimacs", "--metis", "--mtx" or "--snap" and the path of a file,
+// or, with no arguments, the number of vertices and adjacency matrix from stdin
+// Returns false and prints a message if the file can't be loaded
+bool MisSearch::load_input(int argc, char* argv[]) {
+	if (argc >= 3 && argv[1][0] == '-') {
+		if (!load_format(argv[1] + 2, argv[2])) {
+			std::cout << "Could not load " << argv[2] << "\n";
+			return false;
+		}
+	}
+	else if (argc >= 2) {
+		if (!load_csr(argv[1])) {
+			std::cout << "Could not load " << argv[1] << "\n";
+			return false;
+		}
+	}
+	else {
+		std::cin >> N_vertices;
+
+		// Rows are read in order, so the lists come out sorted
+		adj.assign(N_vertices, std::vector<int>());
+		for (int i = 0; i < N_vertices; i++)
+			for (int j = 0; j < N_vertices; j++) {
+				int a;
+				std::cin >> a;
+				if (a && i != j)
+					adj[i].push_back(j);
+			}
 	}
 
-	return result;
+	return relabel_input();
 }
 
-// Returns the intersection of two sets A and B
-std::set<int> set_I(std::set<int> A, std::set<int> B) {
-	std::set<int> result;
+// Relabels the graph by relabel_method, if it is set (see graph_relabel.h)
+// Returns false and prints a message if the method is not known
+bool MisSearch::relabel_input() {
+	input_id.clear();
+	if (relabel_method.empty())
+		return true;
+
+	std::vector<uint64_t> offsets(N_vertices + 1, 0);
+	std::vector<uint32_t> neighbors;
+	for (int v = 0; v < N_vertices; v++) {
+		neighbors.insert(neighbors.end(), adj[v].begin(), adj[v].end());
+		offsets[v + 1] = neighbors.size();
+	}
 
-	for (auto& it : A) {
-		if (B.count(it))
-			result.insert(it);
+	Relabeling r;
+	if (!relabel_graph(relabel_method, N_vertices, offsets.data(), neighbors.data(), r)) {
+		std::cout << "Unknown relabeling " << relabel_method << ", use degree, rcm or bfs\n";
+		return false;
 	}
 
-	return result;
+	set_graph(r.graph.n, r.graph.offsets.data(), r.graph.neighbors.data());
+	input_id.assign(r.old_of.begin(), r.old_of.end());
+	return true;
 }
 
-// Returns true if A is subset of B
-// Returns false otherwise
-bool set_S(std::set<int> A, std::set<int> B) {
-	for (auto& it : A)
-		if (!B.count(it))
-			return false;
-	
-	return true;
+// Exchanges the graph with lists, sorted and without loops, so another
+// tool searches a graph it builds without copying it
+void MisSearch::swap_graph(std::vector<std::vector<int>>& lists) {
+	adj.swap(lists);
+	N_vertices = adj.size();
 }
 
-// Returns a vector of sets
-// Each set has all the vertices in the same component
-// There is no path connecting vertices from different sets
-// using only the vertices in "vertices" set
-std::vector<std::set<int>> connected_components(std::set<int> vertices) {
-	int size = vertices.size();
-	std::vector <int> parent;
-	std::vector <std::set<int>> components;
-	std::vector <std::set<int>> result;
-	parent.resize(size);
-	components.resize(size);
-
-	// Using union-find to identify the components
-	for (int i = 0; i < size; i++)
-		parent[i] = i;
+// Returns the number of v in the input
+int MisSearch::input_vertex(int v) {
+	return input_id.empty() ? v : input_id[v];
+}
 
-	for (auto i = vertices.begin(); i != vertices.end(); i++) {
-		for (auto j = i; j != vertices.end(); j++) {
-			if (edge(*i, *j)) {
-				unite(parent, distance(vertices.begin(), i), distance(vertices.begin(), j));
-			}
+// Returns the vertices of S with their numbers in the input
+std::set<int> MisSearch::input_set(const std::set<int>& S) {
+	if (input_id.empty())
+		return S;
+
+	std::set<int> T;
+	for (int v : S)
+		T.insert(input_id[v]);
+	return T;
+}
+
+// Prepares the search state with X as the vertex set
+// This is the only place where the search allocates memory
+void MisSearch::start_search(const std::set<int>& X) {
+	std::vector<char> in_set(N_vertices, 0);
+	for (int v : X)
+		in_set[v] = 1;
+
+	order.resize(N_vertices);
+	pos.resize(N_vertices);
+	alive = 0;
+	for (int v = 0; v < N_vertices; v++)
+		if (in_set[v]) {
+			order[alive] = v;
+			pos[v] = alive++;
+		}
+	for (int v = 0, k = alive; v < N_vertices; v++)
+		if (!in_set[v]) {
+			order[k] = v;
+			pos[v] = k++;
 		}
+
+	deg.assign(N_vertices, 0);
+	for (int i = 0; i < alive; i++)
+		for (int w : adj[order[i]])
+			if (in_X(w))
+				deg[order[i]]++;
+
+	// A vertex is removed at most once in a path of the search tree
+	removed.clear();
+	removed.reserve(N_vertices);
+	solution.clear();
+	solution.reserve(N_vertices);
+	frames.clear();
+	frames.reserve(N_vertices + 16);
+	seen.assign(N_vertices, 0);
+	stamp = 0;
+
+	// Fixed keys, so the hashes are the same in a resumed search
+	std::mt19937_64 keys(2022);
+	zobrist_key.resize(N_vertices);
+	zobrist_check.resize(N_vertices);
+	for (int v = 0; v < N_vertices; v++) {
+		zobrist_key[v] = keys();
+		zobrist_check[v] = keys();
+	}
+	hash_X();
+	component_order = order;
+	component_pos = pos;
+	scratch.top = 0;
+	if (scratch.data.size() < 4 * (size_t) N_vertices + 16)
+		scratch.data.resize(4 * (size_t) N_vertices + 16);
+}
+
+// Returns true if v is in X
+bool MisSearch::in_X(int v) {
+	return pos[v] < alive;
+}
+
+// Returns the degree of v in X, or 0 if v is not in X
+int MisSearch::degree(int v) {
+	return in_X(v) ? deg[v] : 0;
+}
+
+// Starts a new mark: seen[v] == stamp is false for every v
+void MisSearch::new_stamp() {
+	if (++stamp == 0) {
+		std::fill(seen.begin(), seen.end(), 0);
+		stamp = 1;
 	}
+}
+
+// Removes v from X, if it is there, and logs it to be restored
+// v is swapped with the last vertex of X, so it is O(d(v))
+void MisSearch::remove_vertex(int v) {
+	if (!in_X(v))
+		return;
+
+	int last = order[--alive];
+	order[pos[v]] = last;
+	pos[last] = pos[v];
+	order[alive] = v;
+	pos[v] = alive;
+
+	for (int w : adj[v])
+		if (in_X(w))
+			deg[w]--;
+
+	x_key ^= zobrist_key[v];
+	x_check ^= zobrist_check[v];
+	removed.push_back(v);
+}
+
+// Removes v and its neighboors from X
+// v doesn't need to be in X
+void MisSearch::remove_closed(int v) {
+	for (int w : adj[v])
+		remove_vertex(w);
+	remove_vertex(v);
+}
 
-	// Making a vector of sets with the vertices in each component
-	for (auto i = vertices.begin(); i != vertices.end(); i++) {
-		components[find(parent, distance(vertices.begin(), i))].insert(*i);
+// Restores the vertices removed since the undo log had size point
+// Each one is still right after the end of X when its turn comes
+void MisSearch::restore(size_t point) {
+	while (removed.size() > point) {
+		int v = removed.back();
+		removed.pop_back();
+		alive++;
+		x_key ^= zobrist_key[v];
+		x_check ^= zobrist_check[v];
+
+		for (int w : adj[v])
+			if (in_X(w))
+				deg[w]++;
 	}
+}
 
-	// Excluding empty sets
-	for (auto i = components.begin(); i != components.end(); i++) {
-		if (!(*i).empty())
-			result.push_back(*i);
+// Keeps the biggest of two sets of the solution stack:
+// solution[base, mid) and solution[mid, end)
+// Chooses the first in case of draw
+// Returns the size of the set kept at solution[base, ...)
+int MisSearch::keep_biggest(size_t base, size_t mid) {
+	size_t a = mid - base, b = solution.size() - mid;
+	if (b > a) {
+		std::copy(solution.begin() + mid, solution.end(), solution.begin() + base);
+		solution.resize(base + b);
+		return b;
 	}
 
-	return result;
+	solution.resize(mid);
+	return a;
 }
 
-// Returns a map with {key : value} = {vertex : degree}
-// considering only vertices in X
-std::map<int, int> degrees(std::set<int> X) {
-	std::map<int, int> d;
-	
-	for (auto i = X.begin(); i != X.end(); i++)
-		d.insert({ *i, 0 });
-
-	for (auto i = X.begin(); i != X.end(); i++) {
-		for (auto j = i; j != X.end(); j++) {
-			if (edge(*i, *j)) {
-				d[*i]++;
-				d[*j]++;
+// Groups the vertices of X by connected component in component_order,
+// from position L on, where the range holding all of X starts
+// Component c has the positions [L + scratch[B + c], L + scratch[B + c + 1])
+// and the bounds are written to the scratch space
+// Returns the number of components
+int MisSearch::connected_components(size_t L, size_t& B) {
+	STAT_TIME(components_time);
+	int count = 0, end = 0;
+	B = scratch.take(alive + 1);
+	new_stamp();
+
+	// Swaps v to position p, the vertex there is not in the queue yet
+	auto place = [&](int v, size_t p) {
+		int other = component_order[p];
+		component_order[component_pos[v]] = other;
+		component_pos[other] = component_pos[v];
+		component_order[p] = v;
+		component_pos[v] = p;
+	};
+
+	// Breadth-first search, the list of each component is its queue
+	for (int i = 0; i < alive; i++) {
+		if (seen[order[i]] == stamp)
+			continue;
+
+		scratch[B + count++] = end;
+		seen[order[i]] = stamp;
+		place(order[i], L + end++);
+		for (int k = end - 1; k < end; k++) {
+			for (int w : adj[component_order[L + k]]) {
+				if (in_X(w) && seen[w] != stamp) {
+					seen[w] = stamp;
+					place(w, L + end++);
+				}
 			}
 		}
 	}
+	scratch[B + count] = end;
+	scratch.release(B + count + 1);
+
+	return count;
+}
+
+// Writes to low the k vertices of list that are in X with the lowest degrees,
+// sorted by degree
+// Returns how many were found, less than k if there are less in X
+int MisSearch::lowest_degrees(const int* list, int size, int low[], int k) {
+	STAT_TIME(degrees_time);
+	int found = 0;
+
+	for (int i = 0; i < size; i++) {
+		int v = list[i];
+		if (!in_X(v))
+			continue;
+		if (found == k && deg[v] >= deg[low[k - 1]])
+			continue;
+
+		int j = found < k ? found++ : k - 1;
+		for (; j > 0 && deg[low[j - 1]] > deg[v]; j--)
+			low[j] = low[j - 1];
+		low[j] = v;
+	}
+
+	return found;
+}
 
-	return d;
+// Writes the neighboors of v that are in X to the scratch space,
+// sorted, starting at position S
+// Returns how many they are
+int MisSearch::neighbors_in_X(int v, size_t& S) {
+	int size = 0;
+	S = scratch.take(adj[v].size());
+	for (int w : adj[v])
+		if (in_X(w))
+			scratch[S + size++] = w;
+	scratch.release(S + size);
+
+	return size;
 }
 
-// Function to sort a vector of pairs by the second value
-bool cmp_second(std::pair<int, int> a, std::pair<int, int> b){
-	return a.second < b.second;
+// Writes the neighboors of the neighboors of v that are in X,
+// excluding the neighboors of v and v, to the scratch space,
+// sorted, starting at position S
+// Returns how many they are
+int MisSearch::second_neighbors(int v, size_t& S) {
+	int size = 0;
+	S = scratch.take(alive);
+	new_stamp();
+
+	seen[v] = stamp;
+	for (int w : adj[v])
+		seen[w] = stamp;
+
+	for (int w : adj[v]) {
+		if (!in_X(w))
+			continue;
+		for (int x : adj[w]) {
+			if (in_X(x) && seen[x] != stamp) {
+				seen[x] = stamp;
+				scratch[S + size++] = x;
+			}
+		}
+	}
+	std::sort(scratch.data.begin() + S, scratch.data.begin() + S + size);
+	scratch.release(S + size);
+
+	return size;
 }
 
-// Returns the set of neighboors of v that are in X
-std::set<int> N(int v, std::set<int> X) {
-	std::set<int> result;
-	for (auto& it : X) {
-		if (edge(v, it))
-			result.insert(it);
+// Writes the neighboors of both a and b that are in X
+// to the scratch space, sorted, starting at position C
+// Returns how many they are
+int MisSearch::common_neighbors(int a, int b, size_t& C) {
+	int size = 0;
+	C = scratch.take(std::min(adj[a].size(), adj[b].size()));
+
+	// The lists are sorted, so they are merged
+	auto i = adj[a].begin(), j = adj[b].begin();
+	while (i != adj[a].end() && j != adj[b].end()) {
+		if (*i < *j)
+			i++;
+		else if (*j < *i)
+			j++;
+		else {
+			if (in_X(*i))
+				scratch[C + size++] = *i;
+			i++;
+			j++;
+		}
 	}
+	scratch.release(C + size);
 
-	return result;
+	return size;
 }
 
-// Returns the set of neighboors of v that are in X, including v
-std::set<int> N_C(int v, std::set<int> X) {
-	return set_U(N(v, X), {v});
+// Writes the set S with size S_size without v to the scratch space,
+// starting at position R
+// Returns the size of the new set
+int MisSearch::set_without(size_t S, int S_size, int v, size_t& R) {
+	int size = 0;
+	R = scratch.take(S_size);
+	for (int k = 0; k < S_size; k++)
+		if (scratch[S + k] != v)
+			scratch[R + size++] = scratch[S + k];
+	scratch.release(R + size);
+
+	return size;
 }
 
-// Returns the neighboors of the neighboors of v
-// excluding the neighboors of v and v
-std::set<int> N2(int v, std::set<int> X) {
-	std::set<int> result;
-	std::set<int> neighboors = N(v, X);
+// Writes the set {a, b} to the scratch space, sorted
+// Returns its position
+size_t MisSearch::pair_set(int a, int b) {
+	size_t S = scratch.take(2);
+	scratch[S] = std::min(a, b);
+	scratch[S + 1] = std::max(a, b);
 
-	for (auto& it : neighboors) 
-		result = set_U(result, N(it, X));
+	return S;
+}
 
-	result = set_M(result, neighboors);
-	result.erase(v);
+// Returns true if vertex v dominates vertex u in X
+// (N[v] is a subset of N[u])
+// Returns false otherwise
+bool MisSearch::dominates(int v, int u) {
+	new_stamp();
+	seen[u] = stamp;
+	for (int w : adj[u])
+		seen[w] = stamp;
+
+	if (seen[v] != stamp)
+		return false;
+	for (int w : adj[v])
+		if (in_X(w) && seen[w] != stamp)
+			return false;
 
-	return result;
+	return true;
 }
 
-// Returns true if vertex v dominates vertex u
+// Returns true if the neighboors of e and f in X,
+// except s1, are all neighboors of s2
 // Returns false otherwise
-bool dominates(int v, int u, std::set<int> X) {
-	return set_S(N_C(v, X), N_C(u, X));
+bool MisSearch::covers(int e, int f, int s1, int s2) {
+	new_stamp();
+	for (int w : adj[s2])
+		seen[w] = stamp;
+
+	for (int x : {e, f})
+		for (int w : adj[x])
+			if (w != s1 && in_X(w) && seen[w] != stamp)
+				return false;
+
+	return true;
 }
 
-// Returns the maximum independent set including only X vertices
-// that has exactly one element of S (|S| = 2)
-std::set<int> MIS1(std::set<int> X, std::set<int> S) {
-	auto it1 = S.begin();
-	int s1 = (*it1);
-	std::advance(it1, 1);
-	int s2 = (*it1);
-	std::map<int, int> deg = degrees(X);
+// Pushes a new node of the search tree to the stack
+// committed and pending bound what its ancestors add to its set
+void MisSearch::push_frame(int search, size_t S, int S_size, int committed, int pending) {
+	Frame f;
+	f.search = search;
+	f.S = S;
+	f.S_size = S_size;
+	f.base = f.mid = solution.size();
+	f.point = removed.size();
+	f.top = scratch.top;
+	f.branches = -1;
+	f.next = 0;
+	f.components = false;
+	f.L = frames.empty() ? 0 : frames.back().L;
+	f.B = 0;
+	f.committed = committed;
+	f.pending = pending;
+	f.pruned = false;
+	frames.push_back(f);
+}
 
-	// To make sure d(s1) <= d(s2)
-	if (deg[s1] > deg[s2]) {
-		int aux = s2;
-		s2 = s1;
-		s1 = aux;
+// Plans of a node: no branches (its set is already in the solution stack),
+// one branch or two branches, of which the biggest set is kept
+void MisSearch::plan(Frame& f) {
+	f.branches = 0;
+}
+
+void MisSearch::plan(Frame& f, const Branch& a) {
+	f.branch[0] = a;
+	f.branches = 1;
+}
+
+void MisSearch::plan(Frame& f, const Branch& a, const Branch& b) {
+	f.branch[0] = a;
+	f.branch[1] = b;
+	f.branches = 2;
+}
+
+// Decides the rule of a MIS node: the maximum independent set of X
+void MisSearch::expand_MIS(Frame& f) {
+	if (alive == 0) {
+		STAT_RULE(MIS_EMPTY);
+		return plan(f);
+	}
+
+	// We can unite maximum independent sets
+	// of disconnected components
+	int components = connected_components(f.L, f.B);
+	if (components > 1) {
+		STAT_RULE(MIS_COMPONENTS);
+		f.components = true;
+		f.branches = components;
+		return;
+	}
+	scratch.release(f.top);
+
+	// X is connected, so with one or two vertices any of them is a set,
+	// and with more every vertex has a neighbor for the rules below
+	if (alive <= 2) {
+		STAT_RULE(MIS_SMALL);
+		solution.push_back(order[0]);
+		return plan(f);
+	}
+
+	// Picking the minimal degree vertex
+	int v;
+	lowest_degrees(order.data(), alive, &v, 1);
+
+	// Picking the maximal degree neighboor of v
+	int u = -1;
+	for (int w : adj[v])
+		if (in_X(w) && (u == -1 || deg[w] > deg[u]))
+			u = w;
+
+	if (deg[v] == 1) {
+		STAT_RULE(MIS_DEG1);
+		return plan(f, Branch().close(v).add(v));
+	}
+
+	int u2 = -1;
+	if (deg[v] == 2) {
+		for (int w : adj[v])
+			if (in_X(w) && w != u)
+				u2 = w;
+
+		if (edge(u, u2)) {
+			STAT_RULE(MIS_DEG2_FOLD);
+			return plan(f, Branch().close(v).add(v));
+		}
+	}
+
+	// The rules below branch, which the bitsets do faster on small sets
+	if (alive <= small_limit) {
+		STAT_RULE(BITSET);
+		solve_small();
+		return plan(f);
+	}
+
+	if (deg[v] == 2) {
+		STAT_RULE(MIS_DEG2_BRANCH);
+		size_t N2;
+		int N2_size = second_neighbors(v, N2);
+		return plan(f, Branch().close(u).close(u2).add(u).add(u2), Branch(SEARCH_MIS2, N2, N2_size).close(v).add(v));
+	}
+
+	if (deg[v] == 3) {
+		STAT_RULE(MIS_DEG3);
+		size_t N1;
+		int N1_size = neighbors_in_X(v, N1);
+		return plan(f, Branch(SEARCH_MIS2, N1, N1_size).drop(v), Branch().close(v).add(v));
 	}
 
-	if (deg[s1] <= 1)
-		return MIS(X);
+	if (dominates(v, u)) {
+		STAT_RULE(MIS_DOMINATION);
+		return plan(f, Branch().drop(u));
+	}
+
+	if ((int) frames.size() <= symmetry_depth) {
+		size_t O;
+		int O_size = orbit_of(u, O);
+		if (O_size > 1) {
+			STAT_RULE(MIS_ORBIT);
+			return plan(f, Branch().drop(O, O_size), Branch().close(u).add(u));
+		}
+		scratch.release(O);
+	}
+
+	STAT_RULE(MIS_BRANCH);
+	plan(f, Branch().drop(u), Branch().close(u).add(u));
+}
+
+// Decides the rule of a MIS1 node: the maximum independent set of X
+// that has at least one element of S (|S| = 2)
+void MisSearch::expand_MIS1(Frame& f) {
+	int s1 = scratch[f.S];
+	int s2 = scratch[f.S + 1];
+
+	// To make sure d(s1) <= d(s2)
+	if (degree(s1) > degree(s2))
+		std::swap(s1, s2);
+
+	if (degree(s1) <= 1) {
+		STAT_RULE(MIS1_LOW_DEGREE);
+		return plan(f, Branch());
+	}
 
 	if (edge(s1, s2)) {
-		if (deg[s1] <= 3)
-			return MIS(X);
-		return bigst_set(set_U(MIS(set_M(X, N_C(s1, X))), { s1 }), set_U(MIS(set_M(X, N_C(s2, X))), { s2 }));
+		if (degree(s1) <= 3) {
+			STAT_RULE(MIS1_ADJACENT_LOW);
+			return plan(f, Branch());
+		}
+		STAT_RULE(MIS1_ADJACENT_BRANCH);
+		return plan(f, Branch().close(s1).add(s1), Branch().close(s2).add(s2));
 	}
 
-	if (!set_I(N(s1, X), N(s2, X)).empty())
-		return MIS1(set_M(X, set_I(N(s1, X), N(s2, X))), S);
+	size_t C;
+	int common = common_neighbors(s1, s2, C);
+	if (common) {
+		STAT_RULE(MIS1_COMMON_NEIGHBORS);
+		return plan(f, Branch(SEARCH_MIS1, f.S, f.S_size).drop(C, common));
+	}
+
+	if (degree(s2) == 2) {
+		size_t E;
+		neighbors_in_X(s1, E);
+		int e = scratch[E];
+		int f2 = scratch[E + 1];
 
-	if (deg[s2] == 2) {
-		std::set<int> Ns1 = N(s1, X);
-		auto it2 = Ns1.begin();
-		int e = *it2;
-		std::advance(it2, 1);
-		int f = *it2;
+		if (edge(e, f2)) {
+			STAT_RULE(MIS1_DEG2_TRIANGLE);
+			return plan(f, Branch().close(s1).add(s1));
+		}
 
-		if (edge(e, f))
-			return set_U(MIS(set_M(X, N_C(s1, X))), {s1});
+		if (covers(e, f2, s1, s2)) {
+			STAT_RULE(MIS1_DEG2_COVER);
+			return plan(f, Branch().close(s1).close(s2).add(e).add(f2).add(s2));
+		}
 
-		if (set_S(set_M(set_U(N(e, X), N(f, X)), {s1}), N(s2, X)))
-			return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s2, X)))), {e, f, s2});
-		
-		return bigst_set(set_U(MIS(set_M(X, N_C(s1, X))), { s1 }), set_U(MIS(set_M(X, set_U(N_C(e, X), set_U(N_C(f, X), N_C(s2, X))))), {e, f, s2}));
+		STAT_RULE(MIS1_DEG2_BRANCH);
+		return plan(f, Branch().close(s1).add(s1), Branch().close(e).close(f2).close(s2).add(e).add(f2).add(s2));
 	}
 
-	return bigst_set(set_U(MIS(set_M(X, N_C(s2, X))), { s2 }), set_U(MIS2(set_M(X, set_U(N_C(s1, X), {s2})), N(s2, X)), {s1}));
+	STAT_RULE(MIS1_BRANCH);
+	size_t N2;
+	int N2_size = neighbors_in_X(s2, N2);
+	plan(f, Branch().close(s2).add(s2), Branch(SEARCH_MIS2, N2, N2_size).close(s1).drop(s2).add(s1));
 }
 
-// Returns the maximum independent set including only X vertices
+// Decides the rule of a MIS2 node: the maximum independent set of X
 // with at least two elements of S
-std::set<int> MIS2(std::set<int> X, std::set<int> S) {
-	std::map<int, int> deg = degrees(X);
-	std::vector<std::pair<int, int>> sorted_degrees; // We use vector of pair to sort the degree map
-	for (auto& it : deg)
-		sorted_degrees.push_back(it);
-	std::sort(sorted_degrees.begin(), sorted_degrees.end(), cmp_second);
+void MisSearch::expand_MIS2(Frame& f) {
+	if (f.S_size <= 1) {
+		STAT_RULE(MIS2_SIZE_1);
+		return plan(f);
+	}
 
+	// The vertices of S with the lowest degrees
+	int low[3];
+	if (lowest_degrees(&scratch[f.S], f.S_size, low, 3) < std::min(f.S_size, 3)) {
+		STAT_RULE(MIS2_SIZE_BIG);
+		return plan(f, Branch());
+	}
+	int s1 = low[0], s2 = low[1], s3 = low[2];
 
-	std::set<int> result;
-	if (S.size() <= 1)
-		return result;
+	if (f.S_size == 2) {
+		if (edge(s1, s2)) {
+			STAT_RULE(MIS2_SIZE_2_ADJACENT);
+			return plan(f);
+		}
+		STAT_RULE(MIS2_SIZE_2);
+		return plan(f, Branch().close(s1).close(s2).add(s1).add(s2));
+	}
 
-	auto it = sorted_degrees.begin();
-	int s1 = (*it).first;
-	advance(it, 1);
-	int s2 = (*it).first;
+	if (f.S_size == 3) {
+		size_t R;
+		if (degree(s1) == 0) {
+			STAT_RULE(MIS2_SIZE_3_ISOLATED);
+			int R_size = set_without(f.S, f.S_size, s1, R);
+			return plan(f, Branch(SEARCH_MIS1, R, R_size).close(s1).add(s1));
+		}
 
-	if (S.size() == 2) {
-		if (edge(s1, s2))
-			return result;
-		return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s2, X)))), { s1, s2 });
+		if (edge(s1, s2) && edge(s2, s3) && edge(s3, s1)) {
+			STAT_RULE(MIS2_SIZE_3_TRIANGLE);
+			return plan(f);
+		}
+
+		// Two edges: the ends that are not adjacent go to the set
+		for (int k = 0; k < 3; k++) {
+			if (edge(low[k], low[(k + 1) % 3]) && edge(low[k], low[(k + 2) % 3])) {
+				STAT_RULE(MIS2_SIZE_3_TWO_EDGES);
+				int a = low[(k + 1) % 3], b = low[(k + 2) % 3];
+				return plan(f, Branch().close(a).close(b).add(a).add(b));
+			}
+		}
+
+		// One edge: the vertex out of it goes to the set
+		for (int k = 0; k < 3; k++) {
+			int a = low[k], b = low[(k + 1) % 3], c = low[(k + 2) % 3];
+			if (edge(a, b)) {
+				STAT_RULE(MIS2_SIZE_3_ONE_EDGE);
+				return plan(f, Branch(SEARCH_MIS1, pair_set(a, b), 2).close(c).add(c));
+			}
+		}
+
+		size_t C;
+		if (common_neighbors(s1, s2, C) || common_neighbors(s2, s3, C) || common_neighbors(s1, s3, C)) {
+			STAT_RULE(MIS2_SIZE_3_COMMON_NEIGHBOR);
+			return plan(f, Branch(SEARCH_MIS2, f.S, f.S_size).drop(scratch[C]));
+		}
+
+		int R_size = set_without(f.S, f.S_size, s1, R);
+		if (degree(s1) == 1) {
+			STAT_RULE(MIS2_SIZE_3_DEG1);
+			return plan(f, Branch(SEARCH_MIS1, R, R_size).close(s1).add(s1));
+		}
+
+		STAT_RULE(MIS2_SIZE_3_BRANCH);
+		size_t N1;
+		int N1_size = neighbors_in_X(s1, N1);
+		return plan(f, Branch(SEARCH_MIS1, R, R_size).close(s1).add(s1), Branch(SEARCH_MIS2, N1, N1_size).close(s2).close(s3).drop(s1).add(s2).add(s3));
 	}
 
-	advance(it, 1);
-	int s3 = (*it).first;
+	if (f.S_size == 4) {
+		// If exists v with d(v) <= 3
+		int v;
+		lowest_degrees(order.data(), alive, &v, 1);
+		if (deg[v] <= 3) {
+			STAT_RULE(MIS2_SIZE_4_LOW);
+			return plan(f, Branch());
+		}
 
-	if (S.size() == 3) {
-		if (deg[s1] == 0)
-			set_U(MIS1(set_M(X, { s1 }), set_M(S, {s1})), { s1 });
-		
-		if (edge(s1, s2) && edge(s2, s3) && edge(s3, s1))
-			return result;
+		STAT_RULE(MIS2_SIZE_4_BRANCH);
+		size_t R;
+		int R_size = set_without(f.S, f.S_size, s1, R);
+		return plan(f, Branch().close(s1).add(s1), Branch(SEARCH_MIS2, R, R_size).drop(s1));
+	}
 
-		if (edge(s1, s2) && edge(s1, s3))
-			return set_U(MIS(set_M(X, set_U(N_C(s2, X), N_C(s3, X)))), {s2, s3});
+	STAT_RULE(MIS2_SIZE_BIG);
+	plan(f, Branch());
+}
 
-		if (edge(s2, s1) && edge(s2, s3))
-			return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s3, X)))), { s1, s3 });
-		
-		if (edge(s3, s1) && edge(s3, s2))
-			return set_U(MIS(set_M(X, set_U(N_C(s1, X), N_C(s2, X)))), { s1, s2 });
+// Removes the vertices of the branch br from X
+void MisSearch::remove_branch(const Branch& br) {
+	for (int k = 0; k < br.n_closed; k++)
+		remove_closed(br.closed[k]);
+	if (br.dropped >= 0)
+		remove_vertex(br.dropped);
+	for (int k = 0; k < br.R_size; k++)
+		remove_vertex(scratch[br.R + k]);
+}
 
-		if (edge(s1, s2))
-			return set_U(MIS1(set_M(X, N_C(s3, X)), {s1, s2}), {s3});
+// Removes the vertices of the next branch of f from X
+// and pushes its child to the stack
+void MisSearch::start_branch(Frame& f) {
+	int b = f.next++;
+
+	// X becomes the component b, and its range is where the child groups X
+	if (f.components) {
+		int first = scratch[f.B + b], last = scratch[f.B + b + 1], total = scratch[f.B + f.branches];
+		size_t L = f.L + first;
+		for (int k = 0; k < total; k++)
+			if (k < first || k >= last)
+				remove_vertex(component_order[f.L + k]);
+		push_frame(SEARCH_MIS, 0, 0, f.committed + (solution.size() - f.base), f.pending + (total - last));
+		frames.back().L = L;
+		return;
+	}
 
-		if (edge(s2, s3))
-			return set_U(MIS1(set_M(X, N_C(s1, X)), { s2, s3 }), { s1 });
+	const Branch& br = f.branch[b];
+	remove_branch(br);
 
-		if (edge(s3, s1))
-			return set_U(MIS1(set_M(X, N_C(s2, X)), { s1, s3 }), { s2 });
+	// f may move when the stack grows
+	push_frame(br.search, br.S, br.S_size, f.committed + br.n_added, f.pending);
+}
 
-		std::set<int> intersec;
+// Restores X after the child of the last branch of f returned
+// and adds the vertices of the branch to the set of the child
+void MisSearch::finish_branch(Frame& f) {
+	restore(f.point);
+	if (!f.components) {
+		const Branch& br = f.branch[f.next - 1];
+		solution.insert(solution.end(), br.added, br.added + br.n_added);
+	}
+	if (f.next == 1)
+		f.mid = solution.size();
+}
 
-		intersec = set_I(N(s1, X), N(s2, X));
-		if (!intersec.empty())
-			return MIS2(set_M(X, { *(intersec.begin()) }), S);
+// Returns true if the search must stop after expanded nodes
+bool MisSearch::limit_reached(long long expanded) {
+	if (node_limit && expanded >= node_limit)
+		return true;
 
-		intersec = set_I(N(s2, X), N(s3, X));
-		if (!intersec.empty())
-			return MIS2(set_M(X, { *(intersec.begin()) }), S);
+	// The clock is read only once in a while
+	return time_limit && expanded % 256 == 0
+		&& std::chrono::steady_clock::now() - search_start >= std::chrono::duration<double, std::milli>(time_limit);
+}
 
-		intersec = set_I(N(s1, X), N(s3, X));
-		if (!intersec.empty())
-			return MIS2(set_M(X, { *(intersec.begin()) }), S);
+// Builds an independent set from the node frames[depth]: the vertices the
+// LP reduction and its ancestors add, the components they finished and, if the node finished,
+// the set it found, or else a greedy set of X (lowest degree first)
+// The set is completed greedily with the rest of the graph
+// and kept if it beats the incumbent
+void MisSearch::update_incumbent(size_t depth, bool finished) {
+	candidate = forced_in;
+	for (size_t i = 0; i < depth; i++) {
+		const Frame& f = frames[i];
+		if (f.components)
+			candidate.insert(candidate.end(), solution.begin() + f.base, solution.begin() + frames[i + 1].base);
+		else {
+			const Branch& br = f.branch[f.next - 1];
+			candidate.insert(candidate.end(), br.added, br.added + br.n_added);
+		}
+	}
 
-		if (deg[s1] == 1)
-			return set_U(MIS1(set_M(X, N_C(s1, X)), set_M(S, { s1 })), { s1 });
+	new_stamp();
+	if (finished)
+		candidate.insert(candidate.end(), solution.begin() + frames[depth].base, solution.end());
+	for (int v : candidate) {
+		seen[v] = stamp;
+		for (int w : adj[v])
+			seen[w] = stamp;
+	}
 
-		return bigst_set(set_U(MIS1(set_M(X, N_C(s1, X)), set_M(S, {s1})), { s1 }), MIS2(set_M(X, set_U(set_U(N_C(s2, X), N_C(s3, X)), {s1})), N(s1, X)));
+	if (!finished) {
+		size_t V = scratch.take(alive);
+		std::copy(order.begin(), order.begin() + alive, scratch.data.begin() + V);
+		std::sort(scratch.data.begin() + V, scratch.data.begin() + V + alive, [&](int a, int b) {
+			return deg[a] < deg[b];
+		});
+		for (int k = 0; k < alive; k++) {
+			int v = scratch[V + k];
+			if (seen[v] == stamp)
+				continue;
+			candidate.push_back(v);
+			seen[v] = stamp;
+			for (int w : adj[v])
+				seen[w] = stamp;
+		}
+		scratch.release(V);
 	}
 
-	if (S.size() == 4) {
-		 // If exists v with d(v) <= 3
-		if (sorted_degrees[0].second <= 3)
-			return MIS(X);
-		
-		return bigst_set(set_U(MIS(set_M(X, N_C(s1, X))), { s1 }), MIS2(set_M(X, { s1 }), set_M(S, {s1})));
+	for (int v : by_degree) {
+		if (seen[v] == stamp)
+			continue;
+		candidate.push_back(v);
+		seen[v] = stamp;
+		for (int w : adj[v])
+			seen[w] = stamp;
 	}
 
-	return MIS(X);
+	if (candidate.size() > incumbent.size()) {
+		incumbent = candidate;
+		if (!cancel_flag && !search_progress) // Embedded searches print nothing
+			std::cout << "Found " << incumbent.size() << " vertices after "
+				<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - search_start).count() << " ms\n";
+	}
 }
 
-// Returns the maximum independent set including only X vertices
-std::set<int> MIS(std::set<int> X) {
-	std::set<int> result;
+// Returns the number of cliques of a greedy clique cover of X,
+// an upper bound of its maximum independent set,
+// which has at most one vertex of each clique
+int MisSearch::clique_cover_bound() {
+	int cliques = 0;
+	size_t C = scratch.take(alive);
+	new_stamp();
+
+	for (int i = 0; i < alive; i++) {
+		int v = order[i], size = 0;
+		if (seen[v] == stamp)
+			continue;
+
+		cliques++;
+		seen[v] = stamp;
+		scratch[C + size++] = v;
+		for (int w : adj[v]) {
+			if (!in_X(w) || seen[w] == stamp)
+				continue;
+
+			bool all = true;
+			for (int k = 1; k < size && all; k++)
+				all = edge(w, scratch[C + k]);
+			if (all) {
+				seen[w] = stamp;
+				scratch[C + size++] = w;
+			}
+		}
+	}
+	scratch.release(C);
 
-	if (X.empty())
-		return result;
+	return cliques;
+}
 
-	// We can unite maximum independent sets
-	// of disconnected components 
-	std::vector<std::set<int>> components = connected_components(X);
-	if (components.size() > 1) {
-		for (auto i = components.begin(); i != components.end(); i++)
-			result = set_U(result, MIS(*i));
-		
-		return result;
+// Returns an upper bound of the maximum independent set of the graph
+// when the search stopped with a node not expanded on top of the stack
+// The bound of each ancestor comes from its branches: the size of the
+// sets of the finished ones, the bound of the current one and clique
+// covers of the ones not searched yet, or a clique cover of its X
+// if it is smaller
+// The search state is undone, so the search can't go on after it
+int MisSearch::search_upper_bound() {
+	int bound = clique_cover_bound();
+
+	for (int i = (int) frames.size() - 2; i >= 0; i--) {
+		Frame& f = frames[i];
+		int b = f.next - 1;
+		restore(f.point);
+
+		if (f.components) {
+			// The components after b
+			for (int k = 0; k < scratch[f.B + b + 1]; k++)
+				remove_vertex(component_order[f.L + k]);
+			bound += (frames[i + 1].base - f.base) + clique_cover_bound();
+			restore(f.point);
+		}
+		else if (f.branches == 1)
+			bound += f.branch[0].n_added;
+		else if (b == 1)
+			bound = std::max((int) (f.mid - f.base), bound + f.branch[1].n_added);
+		else {
+			remove_branch(f.branch[1]);
+			int second = clique_cover_bound() + f.branch[1].n_added;
+			restore(f.point);
+			bound = std::max(bound + f.branch[0].n_added, second);
+		}
+
+		bound = std::min(bound, clique_cover_bound());
 	}
 
-	if (X.size() <= 2) {
-		return {*X.begin()};
+	return bound;
+}
+
+// Adds v to the free list or takes it out of it
+void MisSearch::set_free(int v, bool free) {
+	if (free && free_pos[v] < 0) {
+		free_pos[v] = free_list.size();
+		free_list.push_back(v);
+	}
+	else if (!free && free_pos[v] >= 0) {
+		int last = free_list.back();
+		free_list[free_pos[v]] = last;
+		free_pos[last] = free_pos[v];
+		free_list.pop_back();
+		free_pos[v] = -1;
 	}
+}
 
-	std::map<int, int> deg = degrees(X);
-	std::vector<std::pair<int, int>> sorted_degrees; // We use vector of pair to sort the degree map
-	for (auto& it : deg)
-		sorted_degrees.push_back(it);
-	std::sort(sorted_degrees.begin(), sorted_degrees.end(), cmp_second);
+// Queues x to try a swap on it
+void MisSearch::queue_swap(int x) {
+	if (!queued[x]) {
+		queued[x] = 1;
+		swap_queue.push_back(x);
+	}
+}
 
-	// Picking the minimal degree vertex
-	int v = sorted_degrees[0].first;
+// Puts the free vertex v in the solution
+void MisSearch::put_in(int v) {
+	member_pos[v] = members.size();
+	members.push_back(v);
+	set_free(v, false);
+	for (int w : adj[v])
+		if (tight[w]++ == 0)
+			set_free(w, false);
+
+	// Its neighbors have tight 1 now
+	queue_swap(v);
+	if (logging_moves)
+		moves.push_back(v + 1);
+}
 
-	// Picking the maximal degree neighboor of v
-	int u;
-	for (auto it = sorted_degrees.rbegin(); it != sorted_degrees.rend(); it++) {
-		u = (*it).first;
-		if (edge(v, u))
+// Takes v out of the solution
+void MisSearch::take_out(int v) {
+	int last = members.back();
+	members[member_pos[v]] = last;
+	member_pos[last] = member_pos[v];
+	members.pop_back();
+	member_pos[v] = -1;
+
+	for (int w : adj[v]) {
+		if (--tight[w] == 0 && in_X(w))
+			set_free(w, true);
+		else if (tight[w] == 1) {
+			// Its only neighbor in the solution may have a swap now
+			for (int u : adj[w])
+				if (member_pos[u] >= 0) {
+					queue_swap(u);
+					break;
+				}
+		}
+	}
+	set_free(v, true);
+	if (logging_moves)
+		moves.push_back(-(v + 1));
+}
+
+// Tries a (1,2)-swap on x: takes it out and puts in two of its neighbors
+// that aren't adjacent and have no other neighbor in the solution
+// Returns true if it made the swap
+bool MisSearch::try_swap(int x) {
+	int size = 0;
+	size_t L = scratch.take(adj[x].size());
+	for (int w : adj[x])
+		if (tight[w] == 1 && in_X(w))
+			scratch[L + size++] = w;
+
+	for (int i = 0; i + 1 < size; i++) {
+		int u = scratch[L + i];
+		new_stamp();
+		for (int w : adj[u])
+			seen[w] = stamp;
+
+		for (int j = i + 1; j < size; j++) {
+			int w = scratch[L + j];
+			if (seen[w] != stamp) {
+				scratch.release(L);
+				take_out(x);
+				put_in(u);
+				put_in(w);
+				return true;
+			}
+		}
+	}
+	scratch.release(L);
+
+	return false;
+}
+
+// Puts random free vertices in and makes swaps until there are none,
+// which leaves a maximal solution with no (1,2)-swap
+void MisSearch::descend() {
+	while (true) {
+		if (!free_list.empty()) {
+			put_in(free_list[local_rng() % free_list.size()]);
+			continue;
+		}
+		if (swap_queue.empty())
+			return;
+
+		int x = swap_queue.back();
+		swap_queue.pop_back();
+		queued[x] = 0;
+		if (member_pos[x] >= 0 && x != forced)
+			try_swap(x);
+	}
+}
+
+// Undoes the moves of the current iteration, in reverse order
+void MisSearch::undo_moves() {
+	logging_moves = false;
+	while (!moves.empty()) {
+		int m = moves.back();
+		moves.pop_back();
+		if (m > 0)
+			take_out(m - 1);
+		else
+			put_in(-m - 1);
+	}
+	logging_moves = true;
+
+	for (int x : swap_queue)
+		queued[x] = 0;
+	swap_queue.clear();
+}
+
+// Forces k random vertices of X into the solution,
+// taking their neighbors out of it
+void MisSearch::perturb(int k) {
+	for (int i = 0; i < k; i++) {
+		int v = -1;
+		for (int tries = 0; tries < 64 && v < 0; tries++) {
+			int u = order[local_rng() % alive];
+			if (member_pos[u] < 0)
+				v = u;
+		}
+		if (v < 0)
+			return;
+
+		for (int w : adj[v])
+			if (member_pos[w] >= 0)
+				take_out(w);
+		put_in(v);
+		forced = v;
+	}
+}
+
+// Runs the iterated local search on X for time_ms milliseconds
+// and returns the best solution it found
+// Each iteration perturbs the solution and descends from it; a smaller
+// solution is kept with probability 1 / (1 + d * d'), where d and d' are
+// how much smaller it is than the solution before it and the best one,
+// and otherwise its moves are undone
+// In anytime mode and alone it prints each better solution
+std::vector<int> MisSearch::local_search(double time_ms) {
+	auto start = std::chrono::steady_clock::now();
+	bool report = node_limit || time_limit || local_search_time;
+
+	members.clear();
+	member_pos.assign(N_vertices, -1);
+	tight.assign(N_vertices, 0);
+	free_list.clear();
+	free_pos.assign(N_vertices, -1);
+	swap_queue.clear();
+	queued.assign(N_vertices, 0);
+	moves.clear();
+	logging_moves = false;
+	forced = -1;
+
+	for (int i = 0; i < alive; i++)
+		set_free(order[i], true);
+	descend();
+	std::vector<int> best = members;
+	if (report)
+		std::cout << "Found " << best.size() << " vertices after "
+			<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - search_start).count() << " ms\n";
+
+	logging_moves = true;
+	for (long long iteration = 1; alive > 0; iteration++) {
+		if (iteration % 64 == 0
+			&& std::chrono::steady_clock::now() - start >= std::chrono::duration<double, std::milli>(time_ms))
 			break;
+
+		// Mostly one vertex, sometimes a few more
+		int k = 1;
+		if (local_rng() % (2 * members.size() + 1) == 0)
+			while (k < 8 && local_rng() % 2)
+				k++;
+
+		size_t before = members.size();
+		moves.clear();
+		perturb(k);
+		descend();
+		forced = -1;
+
+		if (members.size() > best.size()) {
+			best = members;
+			if (report)
+				std::cout << "Found " << best.size() << " vertices after "
+					<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - search_start).count() << " ms\n";
+		}
+		else if (members.size() < before) {
+			unsigned long long d = before - members.size(), d_best = best.size() - members.size();
+			if (local_rng() % (1 + d * d_best) != 0)
+				undo_moves();
+		}
 	}
+	logging_moves = false;
 
-	if (deg[v] == 1) 
-		return set_U({v}, MIS(set_M(X, N_C(v, X))));
+	return best;
+}
 
-	if (deg[v] == 2) {
-		int u2 = *(set_M(N(v, X), { u }).begin());
-		if (edge(u, u2))
-			return set_U({ v }, MIS(set_M(X, N_C(v, X))));
+// Solves the LP relaxation of vertex cover of X: matches the double cover
+// with the Blossom and fills lp_value with 2 * x_v of each vertex of X,
+// from the minimum vertex cover of Konig's theorem (the left copies not
+// reached from a free left copy by an alternating path, and the right
+// copies reached)
+// Returns the size of the matching
+int MisSearch::lp_solve() {
+	int k = alive;
+	lp_index.resize(N_vertices);
+	for (int i = 0; i < k; i++)
+		lp_index[order[i]] = i;
+
+	lp_blossom.reset(2 * k);
+	for (int i = 0; i < k; i++)
+		for (int w : adj[order[i]])
+			if (in_X(w))
+				lp_blossom.addEdge(i, k + lp_index[w]);
+	int nu = lp_blossom.edmondsBlossomAlgorithm();
+
+	// Alternating paths: left to right by any edge, right to left by its mate
+	lp_reached.assign(2 * k, 0);
+	size_t Q = scratch.take(2 * k);
+	int head = 0, tail = 0;
+	for (int i = 0; i < k; i++)
+		if (lp_blossom.mateOf(i) < 0) {
+			lp_reached[i] = 1;
+			scratch[Q + tail++] = i;
+		}
+	while (head < tail) {
+		int i = scratch[Q + head++];
+		for (int w : adj[order[i]]) {
+			int r = k + lp_index[w];
+			if (!in_X(w) || lp_reached[r])
+				continue;
+			lp_reached[r] = 1;
+			int m = lp_blossom.mateOf(r);
+			if (m >= 0 && !lp_reached[m]) {
+				lp_reached[m] = 1;
+				scratch[Q + tail++] = m;
+			}
+		}
+	}
+	scratch.release(Q);
+
+	lp_value.resize(k);
+	for (int i = 0; i < k; i++)
+		lp_value[i] = !lp_reached[i] + lp_reached[k + i];
+
+	return nu;
+}
+
+// Returns the LP bound of the maximum independent set of X,
+// or |X| if X is too big for the Blossom
+int MisSearch::lp_bound() {
+	if (alive > LP_LIMIT)
+		return alive;
+	return alive - (lp_solve() + 1) / 2;
+}
+
+// Applies the LP reduction to X before the search: the vertices with
+// x_v = 0 go to the solution stack and forced_in, and leave X with the ones
+// with x_v = 1, which are their neighbors and others
+// Sets lp_root_bound to the bound of the whole X
+void MisSearch::lp_reduce() {
+	forced_in.clear();
+	lp_root_bound = alive;
+	if (!lp_reduction || alive > LP_LIMIT)
+		return;
+
+	lp_root_bound = alive - (lp_solve() + 1) / 2;
+
+	size_t V = scratch.take(alive);
+	int k = alive;
+	std::copy(order.begin(), order.begin() + k, scratch.data.begin() + V);
+	for (int i = 0; i < k; i++) {
+		int v = scratch[V + i];
+		if (lp_value[i] == 0) {
+			forced_in.push_back(v);
+			solution.push_back(v);
+			remove_closed(v);
+		}
+	}
+	for (int i = 0; i < k; i++)
+		if (lp_value[i] == 2)
+			remove_vertex(scratch[V + i]);
+	scratch.release(V);
+}
+
+// Returns false if the node f can't lead to a set bigger than the incumbent:
+// its ancestors add f.committed vertices to its set, the components searched
+// after it have f.pending vertices, and its set has at most the vertices
+// of X, at most one vertex of each clique of a clique cover of X, and no
+// more than the LP bound, which is only tried when the cover almost prunes
+bool MisSearch::can_improve(const Frame& f) {
+	int needed = (int) incumbent.size() - f.committed - f.pending;
+	if (alive <= needed)
+		return false;
+
+	CacheEntry e;
+	if (alive >= CACHE_MIN_VERTICES && cache.enabled() && cache.find(x_key, x_check, alive, e) && e.value <= needed) {
+		STAT_RULE(CACHED_BOUND);
+		return false;
+	}
+
+	int cover = clique_cover_bound();
+	if (cover <= needed) {
+		cache_bound(cover);
+		return false;
+	}
+	if (lp_reduction && cover - needed <= 2) {
+		int lp = lp_bound();
+		if (lp <= needed) {
+			STAT_RULE(LP_PRUNED);
+			cache_bound(lp);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Refines the colors (0 to colors - 1) of the vertices of G[X], by position,
+// until the vertices of each color have the same number of neighbors of
+// each color. The new colors are numbered in the order of these signatures,
+// so isomorphic colorings give matching colors
+// Returns the number of colors
+int MisSearch::refine(std::vector<int>& color, int colors) {
+	int k = color.size();
+	std::vector<std::vector<int>> signature(k);
+	std::vector<int> by_signature(k);
+
+	while (true) {
+		for (int i = 0; i < k; i++) {
+			signature[i].assign(1, color[i]);
+			for (int j : sym_adj[i])
+				signature[i].push_back(color[j]);
+			std::sort(signature[i].begin() + 1, signature[i].end());
+			by_signature[i] = i;
+		}
+		std::sort(by_signature.begin(), by_signature.end(), [&](int a, int b) {
+			return signature[a] < signature[b];
+		});
+
+		int next = 0;
+		for (int r = 0; r < k; r++) {
+			if (r > 0 && signature[by_signature[r]] != signature[by_signature[r - 1]])
+				next++;
+			color[by_signature[r]] = next;
+		}
+		next = k ? next + 1 : 0;
+
+		// Classes only split, so the same number means nothing changed
+		if (next == colors)
+			return colors;
+		colors = next;
+	}
+}
+
+// Returns true if an automorphism of G[X] maps the coloring a to b,
+// both with colors colors, and fills map with it (by position in X)
+// Refines both, then individualizes the first vertex of the first class
+// with more than one vertex in a and tries each vertex of that class in b
+// Gives up, returning false, after budget colorings
+bool MisSearch::automorphism(std::vector<int> a, std::vector<int> b, int colors, int& budget, std::vector<int>& map) {
+	if (--budget < 0)
+		return false;
+
+	int k = a.size();
+	int ca = refine(a, colors), cb = refine(b, colors);
+	if (ca != cb)
+		return false;
+	std::vector<int> size_a(ca, 0), size_b(ca, 0);
+	for (int i = 0; i < k; i++)
+		size_a[a[i]]++, size_b[b[i]]++;
+	if (size_a != size_b)
+		return false;
+
+	if (ca == k) {
+		std::vector<int> of_color(k);
+		for (int i = 0; i < k; i++)
+			of_color[b[i]] = i;
+		for (int i = 0; i < k; i++)
+			map[i] = of_color[a[i]];
+		for (int i = 0; i < k; i++)
+			for (int j : sym_adj[i])
+				if (!std::binary_search(sym_adj[map[i]].begin(), sym_adj[map[i]].end(), map[j]))
+					return false;
+		return true;
+	}
+
+	int c = 0;
+	while (size_a[c] == 1)
+		c++;
+	int x = std::find(a.begin(), a.end(), c) - a.begin();
+	for (int y = 0; y < k; y++) {
+		if (b[y] != c)
+			continue;
+		std::vector<int> a2 = a, b2 = b;
+		a2[x] = b2[y] = ca;
+		if (automorphism(a2, b2, ca + 1, budget, map))
+			return true;
+		if (budget < 0)
+			return false;
+	}
+
+	return false;
+}
+
+// Finds vertices of the orbit of u in the automorphisms of G[X]: each
+// automorphism found joins the orbits of its cycles, so most vertices
+// don't need a search of their own
+// Returns the number of vertices found, in O in the scratch space, u first
+int MisSearch::orbit_of(int u, size_t& O) {
+	int k = alive;
+	sym_adj.resize(std::max<size_t>(sym_adj.size(), k));
+	for (int i = 0; i < k; i++) {
+		sym_adj[i].clear();
+		for (int w : adj[order[i]])
+			if (in_X(w))
+				sym_adj[i].push_back(pos[w]);
+		std::sort(sym_adj[i].begin(), sym_adj[i].end());
+	}
+	sym_adj.resize(k);
+
+	std::vector<int> base(k, 0), map(k), parent(k);
+	int colors = refine(base, 1);
+	for (int i = 0; i < k; i++)
+		parent[i] = i;
+	auto root = [&](int i) {
+		while (parent[i] != i)
+			i = parent[i] = parent[parent[i]];
+		return i;
+	};
+
+	int iu = pos[u];
+	for (int iw = 0; iw < k; iw++) {
+		if (iw == iu || base[iw] != base[iu] || root(iw) == root(iu))
+			continue;
+		std::vector<int> a = base, b = base;
+		a[iu] = b[iw] = colors;
+		int budget = SYMMETRY_LIMIT;
+		if (automorphism(a, b, colors + 1, budget, map))
+			for (int i = 0; i < k; i++)
+				parent[root(i)] = root(map[i]);
+	}
+
+	O = scratch.take(k);
+	int size = 0;
+	scratch[O + size++] = u;
+	for (int i = 0; i < k; i++)
+		if (i != iu && root(i) == root(iu))
+			scratch[O + size++] = order[i];
+	scratch.release(O + size);
+
+	return size;
+}
+
+// Puts a maximum independent set of X, which has at most 64 * W
+// vertices, in the solution stack
+// The search is allocated the first time, since it is too big for the
+// stack with 512 vertices, and then kept
+template <int W>
+void MisSearch::solve_bitset(std::unique_ptr<BitsetSearch<W>>& search) {
+	if (!table)
+		table.reset(new SmallTable());
+	if (!search) {
+		search.reset(new BitsetSearch<W>());
+		search->table = table.get();
+	}
+	for (int i = 0; i < alive; i++) {
+		search->nb[i] = VertexSet<W>::none();
+		for (int w : adj[order[i]])
+			if (in_X(w))
+				search->nb[i].add(pos[w]);
+	}
+
+	VertexSet<W> set;
+	search->solve(VertexSet<W>::first(alive), -1, set);
+	set.for_each([&](int i) {
+		solution.push_back(order[i]);
+	});
+}
+
+// Solves X with the narrowest bitsets that fit it
+void MisSearch::solve_small() {
+	if (alive <= 64)
+		solve_bitset(bitset1);
+	else if (alive <= 128)
+		solve_bitset(bitset2);
+	else if (alive <= 256)
+		solve_bitset(bitset4);
+	else
+		solve_bitset(bitset8);
+}
+
+// Sets the hashes of X from its vertices
+void MisSearch::hash_X() {
+	x_key = x_check = 0;
+	for (int i = 0; i < alive; i++) {
+		x_key ^= zobrist_key[order[i]];
+		x_check ^= zobrist_check[order[i]];
+	}
+}
+
+// Looks up the MIS node f in the table and, if its set is there,
+// puts it in the solution stack
+// Returns true if it found the set
+bool MisSearch::cache_lookup(Frame& f) {
+	CacheEntry e;
+	if (f.search != SEARCH_MIS || alive < CACHE_MIN_VERTICES || !cache.enabled()
+		|| !cache.find(x_key, x_check, alive, e) || !e.exact)
+		return false;
+
+	solution.insert(solution.end(), e.set.begin(), e.set.end());
+	return true;
+}
+
+// Keeps a bound of the maximum independent set of X
+void MisSearch::cache_bound(int value) {
+	if (alive < CACHE_MIN_VERTICES || !cache.enabled())
+		return;
+
+	CacheEntry e;
+	e.check = x_check;
+	e.vertices = alive;
+	e.exact = false;
+	e.value = value;
+	cache.store(x_key, e);
+}
+
+// Keeps the set of the MIS node f, which just finished with X restored
+// after nodes nodes
+void MisSearch::cache_store(const Frame& f, long long nodes) {
+	if (f.search != SEARCH_MIS || f.pruned || nodes < CACHE_MIN_NODES || alive < CACHE_MIN_VERTICES || !cache.enabled())
+		return;
+
+	CacheEntry e;
+	e.check = x_check;
+	e.vertices = alive;
+	e.exact = true;
+	e.set.assign(solution.begin() + f.base, solution.end());
+	e.value = e.set.size();
+	cache.store(x_key, e);
+}
+
+// Runs the search in the stack until it is empty
+// With checkpoint_path set, the state is saved every checkpoint_interval
+// seconds, and the search stops after saving it if a stop was requested
+// With node_limit or time_limit set, it keeps the incumbent up to date
+// and stops at the limit, with a node not expanded on top of the stack,
+// and it stops the same way when cancel_flag is set
+// With an incumbent, the nodes that can't beat it find the empty set
+// MIS nodes take their sets from the transposition table when they can,
+// and expand_MIS solves the ones with at most small_limit vertices with
+// bitsets: bitset_limit, or at most 64 with limits, checkpoints or hooks
+// since each one is a single step
+// Returns true if the search finished
+bool MisSearch::run_search() {
+	auto last_checkpoint = std::chrono::steady_clock::now(), last_progress = last_checkpoint;
+	long long steps = 0, expanded = 0, finished = 0;
+	bool anytime = node_limit || time_limit, hooks = cancel_flag || search_progress;
+	small_limit = anytime || hooks || !checkpoint_path.empty() ? std::min(bitset_limit, 64) : bitset_limit;
+
+	while (!frames.empty()) {
+		if (!checkpoint_path.empty() && (stop_requested || ++steps % 4096 == 0)) {
+			auto now = std::chrono::steady_clock::now();
+			if (stop_requested || now - last_checkpoint >= std::chrono::duration<double>(checkpoint_interval)) {
+				if (!save_checkpoint(checkpoint_path.c_str()))
+					std::cerr << "Could not write the checkpoint " << checkpoint_path << "\n";
+				last_checkpoint = now;
+				if (stop_requested) {
+					std::cerr << "Search stopped, continue it with --resume " << checkpoint_path << "\n";
+					return false;
+				}
+			}
+		}
+
+		Frame& f = frames.back();
+		if (f.branches < 0) {
+			if (anytime && expanded % 1024 == 0)
+				update_incumbent(frames.size() - 1, false);
+			if (anytime && limit_reached(expanded)) {
+				search_limited = true;
+				if (!checkpoint_path.empty() && !save_checkpoint(checkpoint_path.c_str()))
+					std::cerr << "Could not write the checkpoint " << checkpoint_path << "\n";
+				return false;
+			}
+			if (cancel_flag && cancel_flag->load(std::memory_order_relaxed)) {
+				search_limited = search_cancelled = true;
+				return false;
+			}
+			if (search_progress) {
+				auto now = std::chrono::steady_clock::now();
+				if (now - last_progress >= std::chrono::duration<double, std::milli>(progress_interval)) {
+					update_incumbent(frames.size() - 1, false);
+					search_progress(expanded, incumbent.size());
+					last_progress = now;
+				}
+			}
+			f.first_node = expanded++;
+			search_nodes = expanded;
+
+			STAT_NODE(f.search, frames.size() - 1);
+			if (cache_lookup(f)) {
+				STAT_RULE(CACHED);
+				plan(f);
+			}
+			else if (!incumbent.empty() && !can_improve(f)) {
+				STAT_RULE(PRUNED);
+				f.pruned = true;
+				plan(f);
+			}
+			else if (f.search == SEARCH_MIS)
+				expand_MIS(f);
+			else if (f.search == SEARCH_MIS1)
+				expand_MIS1(f);
+			else
+				expand_MIS2(f);
+		}
 		else
-			return bigst_set(set_U({u, u2}, MIS(set_M(X, set_U(N_C(u, X), N_C(u2, X))))), set_U({v}, MIS2(set_M(X, N_C(v, X)), N2(v, X))));
+			finish_branch(f);
+
+		if (f.next < f.branches) {
+			start_branch(f);
+			continue;
+		}
+
+		if (!f.components && f.branches == 2)
+			keep_biggest(f.base, f.mid);
+		cache_store(f, expanded - f.first_node);
+		if (f.pruned && frames.size() > 1)
+			frames[frames.size() - 2].pruned = true;
+		// The sets of the nodes near the root are the best ones to build on
+		if (anytime && (frames.size() <= 16 || ++finished % 64 == 0))
+			update_incumbent(frames.size() - 1, true);
+		scratch.release(f.top);
+		frames.pop_back();
+	}
+
+	return true;
+}
+
+// Hash of the graph, so a checkpoint is only resumed with its own graph
+uint64_t MisSearch::graph_hash() {
+	uint64_t h = 14695981039346656037ULL; // FNV-1a
+	auto mix = [&h](uint64_t x) {
+		h = (h ^ x) * 1099511628211ULL;
+	};
+
+	mix(N_vertices);
+	for (int v = 0; v < N_vertices; v++) {
+		for (int w : adj[v])
+			mix(w);
+		mix(-1);
 	}
 
-	if (deg[v] == 3)
-		return bigst_set(MIS2(set_M(X, {v}), N(v, X)), set_U({v}, MIS(set_M(X, N_C(v, X)))));
+	return h;
+}
 
-	if (dominates(v, u, X))
-		return MIS(set_M(X, {u}));
+// Writes size elements of data to file
+// Returns false if they can't be written
+template <typename T>
+bool write_array(FILE* file, const T* data, size_t size) {
+	return size == 0 || fwrite(data, sizeof(T), size, file) == size;
+}
 
-	return bigst_set(MIS(set_M(X, {u})), set_U({u}, MIS(set_M(X, N_C(u, X)))));
+// Reads size elements from file to data
+// Returns false if they can't be read
+template <typename T>
+bool read_array(FILE* file, T* data, size_t size) {
+	return size == 0 || fread(data, sizeof(T), size, file) == size;
 }
 
-// Input the number of vertices and adjacency matrix
-// Prints the maximum independent set
-int main() {
-	std::cin >> N_vertices;
+// Writes the state of the search to path
+// The file is written to path.tmp and renamed, so a process killed
+// while writing it leaves the last checkpoint whole
+// Returns false if it can't be written
+bool MisSearch::save_checkpoint(const char* path) {
+	CheckpointHeader h;
+	memcpy(h.magic, CHECKPOINT_MAGIC, 8);
+	h.n = N_vertices;
+	h.hash = graph_hash();
+	h.frame_size = sizeof(Frame);
+	h.alive = alive;
+	h.removed = removed.size();
+	h.solution = solution.size();
+	h.scratch = scratch.top;
+	h.frames = frames.size();
+	h.incumbent = incumbent.size();
+
+	std::string tmp = std::string(path) + ".tmp";
+	FILE* file = fopen(tmp.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool ok = write_array(file, &h, 1) && write_array(file, order.data(), N_vertices)
+		&& write_array(file, pos.data(), N_vertices) && write_array(file, deg.data(), N_vertices)
+		&& write_array(file, component_order.data(), N_vertices)
+		&& write_array(file, removed.data(), removed.size()) && write_array(file, solution.data(), solution.size())
+		&& write_array(file, scratch.data.data(), scratch.top) && write_array(file, frames.data(), frames.size())
+		&& write_array(file, incumbent.data(), incumbent.size());
+
+	if (fclose(file) || !ok || rename(tmp.c_str(), path)) {
+		remove(tmp.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+// Replaces the state of the search with the one saved in path
+// The incumbent is saved too, since the search pruned nodes with it
+// start_search must have been called with the same graph
+// Returns false if the file can't be read or is from another graph
+bool MisSearch::load_checkpoint(const char* path) {
+	CheckpointHeader h;
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		return false;
+
+	bool ok = read_array(file, &h, 1) && !memcmp(h.magic, CHECKPOINT_MAGIC, 8) && h.n == (uint64_t) N_vertices
+		&& h.hash == graph_hash() && h.frame_size == sizeof(Frame);
+	if (ok) {
+		alive = h.alive;
+		removed.resize(h.removed);
+		solution.resize(h.solution);
+		if (scratch.data.size() < h.scratch)
+			scratch.data.resize(h.scratch);
+		scratch.top = h.scratch;
+		frames.resize(h.frames);
+		incumbent.resize(h.incumbent);
+
+		ok = read_array(file, order.data(), N_vertices) && read_array(file, pos.data(), N_vertices)
+			&& read_array(file, deg.data(), N_vertices) && read_array(file, component_order.data(), N_vertices)
+			&& read_array(file, removed.data(), removed.size())
+			&& read_array(file, solution.data(), solution.size()) && read_array(file, scratch.data.data(), scratch.top)
+			&& read_array(file, frames.data(), frames.size()) && read_array(file, incumbent.data(), incumbent.size());
+		hash_X();
+		for (int k = 0; ok && k < N_vertices; k++)
+			component_pos[component_order[k]] = k;
+	}
+
+	fclose(file);
+	return ok;
+}
+
+// Asks the search to save a checkpoint and stop (SIGTERM and SIGINT)
+void request_stop(int) {
+	stop_requested = 1;
+}
+
+// Takes the options of the search out of argv:
+// "--checkpoint FILE" saves the state of the search to FILE every
+// "--interval SECONDS" (300 by default) and when the process gets SIGTERM or SIGINT
+// "--resume FILE" continues the search saved in FILE, with the same graph
+// "--time-limit MILLISECONDS" and "--node-limit NODES" stop the search
+// at the limit with the best set found and an upper bound
+// "--local-search MILLISECONDS" runs only the local search and gives
+// its best set and an upper bound, and "--warm-start MILLISECONDS" runs it
+// before the exact search, which prunes the nodes that can't beat it
+// "--no-lp" turns off the LP reduction and bound
+// "--cache MEGABYTES" sets the memory of the transposition table (64 by
+// default, 0 turns it off)
+// "--symmetry DEPTH" branches on orbits in the nodes above DEPTH
+// "--bitset VERTICES" solves the nodes with up to VERTICES vertices (128 by
+// default, from 1 to 512) with bitsets
+// Returns the number of arguments left
+int MisSearch::search_options(int argc, char* argv[]) {
+	int left = 1;
+	for (int k = 1; k < argc; k++) {
+		std::string option = argv[k];
+		if (k + 1 < argc && option == "--checkpoint")
+			checkpoint_path = argv[++k];
+		else if (k + 1 < argc && option == "--interval")
+			checkpoint_interval = atof(argv[++k]);
+		else if (k + 1 < argc && option == "--resume")
+			resume_path = argv[++k];
+		else if (k + 1 < argc && option == "--time-limit")
+			time_limit = atof(argv[++k]);
+		else if (k + 1 < argc && option == "--node-limit")
+			node_limit = atoll(argv[++k]);
+		else if (k + 1 < argc && option == "--local-search")
+			local_search_time = atof(argv[++k]);
+		else if (k + 1 < argc && option == "--warm-start")
+			warm_start_time = atof(argv[++k]);
+		else if (option == "--no-lp")
+			lp_reduction = false;
+		else if (k + 1 < argc && option == "--cache")
+			cache_mb = atof(argv[++k]);
+		else if (k + 1 < argc && option == "--symmetry")
+			symmetry_depth = atoi(argv[++k]);
+		else if (k + 1 < argc && option == "--bitset")
+			bitset_limit = std::max(1, std::min(atoi(argv[++k]), BITSET_LIMIT));
+		else
+			argv[left++] = argv[k];
+	}
+
+	return left;
+}
+
+// Returns the maximum independent set including only X vertices
+// Sets search_finished to false if the search was stopped
+// or couldn't be resumed
+// If it stopped at a limit or was cancelled, sets search_limited (and
+// search_cancelled) and returns the best set found, with an upper bound
+// of the maximum in search_bound
+// With local_search_time set it returns the set of the local search
+// the same way, and with warm_start_time set the local search gives
+// the first incumbent of the exact search
+std::set<int> MisSearch::MIS(std::set<int> X) {
+	start_search(X);
+	cache.reset(cache_mb * (1 << 20)); // Its keys are only valid for this graph
+	search_finished = search_limited = search_cancelled = false;
+	search_nodes = 0;
+	search_start = std::chrono::steady_clock::now();
+	incumbent.clear();
+	candidate.reserve(N_vertices);
+	by_degree.assign(order.begin(), order.begin() + alive);
+	std::stable_sort(by_degree.begin(), by_degree.end(), [&](int a, int b) {
+		return adj[a].size() < adj[b].size();
+	});
+
+	// Deterministic, so a resumed search has the same forced_in
+	lp_reduce();
+
+	if (!resume_path.empty()) {
+		if (!load_checkpoint(resume_path.c_str())) {
+			std::cerr << "Could not resume from " << resume_path << ", it is not a checkpoint of this graph\n";
+			return std::set<int>();
+		}
+	}
+	else
+		push_frame(SEARCH_MIS, 0, 0, forced_in.size(), 0);
+
+	if (local_search_time || warm_start_time) {
+		std::vector<int> found = local_search(local_search_time ? local_search_time : warm_start_time);
+		found.insert(found.end(), forced_in.begin(), forced_in.end());
+		if (found.size() > incumbent.size())
+			incumbent = found;
+		if (local_search_time) {
+			search_finished = search_limited = true;
+			search_bound = std::min(lp_root_bound, (int) forced_in.size() + clique_cover_bound());
+			return std::set<int>(incumbent.begin(), incumbent.end());
+		}
+	}
+
+	if (!checkpoint_path.empty()) {
+		signal(SIGTERM, request_stop);
+		signal(SIGINT, request_stop);
+	}
+
+	search_finished = run_search();
 
-	for (int i = 0; i < N_vertices; i++)
-		for (int j = 0; j < N_vertices; j++)
-			std::cin >> mat[i][j];
+	if (search_limited) {
+		update_incumbent(frames.size() - 1, false);
+		// Pruned nodes found less than they could, but no more than the incumbent
+		int bound = std::min(lp_root_bound, (int) forced_in.size() + search_upper_bound());
+		search_bound = std::max(bound, (int) incumbent.size());
+		return std::set<int>(incumbent.begin(), incumbent.end());
+	}
+
+	if (incumbent.size() > solution.size())
+		solution = incumbent;
+	search_bound = solution.size();
+	return std::set<int>(solution.begin(), solution.end());
+}
+
+#ifndef NO_MAIN
+// Input the number of vertices and adjacency matrix,
+// or the path of a binary CSR file as argument,
+// or "--dimacs", "--metis", "--mtx" or "--snap" and the path of a file
+// Long searches can be saved with "--checkpoint FILE [--interval SECONDS]"
+// and continued with "--resume FILE"
+// With "--time-limit MILLISECONDS" or "--node-limit NODES" it prints each
+// better set it finds and, at the limit, the best one and an upper bound
+// "--local-search MILLISECONDS" prints the best set of a local search
+// and an upper bound, and "--warm-start MILLISECONDS" seeds the search with it
+// "--no-lp" searches without the LP reduction, and "--cache MEGABYTES" sets
+// the memory of the table of sets of repeated subproblems
+// "--symmetry DEPTH" branches on orbits of automorphisms near the root
+// "--bitset VERTICES" sets the size of the subproblems solved with bitsets
+// "--relabel degree|rcm|bfs" renumbers the vertices before the search,
+// see graph_relabel.h, and the set is printed with the input numbers
+// Prints the maximum independent set
+int main(int argc, char* argv[]) {
+	MisSearch search;
+	argc = relabel_options(argc, argv, search.relabel_method);
+	argc = search.search_options(argc, argv);
+	if (!search.load_input(argc, argv))
+		return 1;
 
 	// Building the set of vertices
 	std::set<int> X;
-	for (int i = 0; i < N_vertices; i++)
+	for (int i = 0; i < search.N_vertices; i++)
 		X.insert(i);
 
-	std::set<int> max_set = MIS(X);
+	std::set<int> max_set = search.MIS(X);
+	if (!search.search_finished && !search.search_limited)
+		return 2;
+	max_set = search.input_set(max_set);
 	
 	// Printing the maximum independent set
-	std::cout << "Maximum Independent Set = {";
+	std::cout << (search.search_limited ? "Best Independent Set = {" : "Maximum Independent Set = {");
 	for (auto it = max_set.begin(); it != std::prev(max_set.end()); it++)
 		std::cout << *it << ", ";
 	if (!max_set.empty())
 		std::cout << *(max_set.rbegin());
 	std::cout << "}\n";
+	if (search.search_limited)
+		std::cout << "Upper bound = " << search.search_bound << "\n";
+
+#ifdef MIS_STATS
+	search.print_stats(std::cerr);
+#endif
 
 	return 0;
 }
+#endif
@@ -3,57 +3,145 @@
 // Comments and modifications by Daniel Campos da Silva
 
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "graph_csr.h"
+#include "graph_formats.h"
+#include "graph_relabel.h"
+#include "graph_compressed.h"
 
 using namespace std;
 
+string relabel_method; // Relabeling of the CSR graphs, empty for none
+
 struct StructEdge {
     int v;
     StructEdge* n;
 };
 typedef StructEdge* Edge;
 
+// Gallai-Edmonds partition of the vertices
+// D: vertices missed by some maximum matching
+// A: vertices not in D with a neighbor in D
+// C: the remaining vertices, perfectly matched among themselves
+// A is a Tutte-Berge witness: a maximum matching has
+// (V + |A| - odd(G - A)) / 2 edges, where odd(G - A)
+// is the number of odd components of G without A
+struct Decomposition {
+    vector<char> part; // part[v] = 'D', 'A' or 'C'
+    vector<int> D, A, C;
+    int odd_components; // odd(G - A)
+    bool certified; // true if the formula meets the matching size
+};
+
 class Blossom{
-    vector<StructEdge> pool;
-    Edge top;
+    vector<vector<StructEdge>> pool;
+    size_t chunk, top;
+    Edge freed;
     vector<Edge> adj;
-    int V, qh, qt;
+    int V, qh, qt, match_counts;
     vector<int> match, q, father, base;
     vector<bool> inq, inb;
     vector<vector<bool>> ed;
 
 public:
+    // Another thread stops edmondsBlossomAlgorithm by setting *cancel,
+    // which find_augmenting_path reads every 1024 vertices it takes from
+    // the queue, and the matching found so far is kept
+    const atomic<bool>* cancel = NULL;
+
+    // Called every 64 vertices edmondsBlossomAlgorithm searches from,
+    // with how many it searched and the size of the matching
+    function<void(int searched, int matches)> progress;
+
     Blossom(int V){
+        reset(V);
+    }
+
+    // Empties the graph and prepares it for V vertices
+    // Keeps the memory already allocated, so one Blossom
+    // can solve many graphs in a row
+    void reset(int V){
         this->V = V; // Number of vertices
-        pool.resize(V * V * 2); // Area to place edges
-        top = &(pool[0]); // Most recent edge
-        adj.resize(V); // adj[v] = {v, u}, start of a linked list of edges
-        match.resize(V); // mate[v] = u if {u, v} is in matching
+        chunk = top = 0; // pool[chunk][top] is the next free edge
+        freed = NULL; // Linked list of removed edges, reused before the pool
+        adj.assign(V, NULL); // adj[v] = {v, u}, start of a linked list of edges
+        match.assign(V, -1); // mate[v] = u if {u, v} is in matching
+        match_counts = 0; // Number of edges in the matching
         q.resize(V); // queue
         father.resize(V); // father[v] = u if v came from u in the forest
         base.resize(V); // Base[v]=u if v is in a contracted blossom of base u
         inq.resize(V); // inq[v] = true if v is in queue
-        ed.assign(V, vector<bool>(V)); // ed[i][j] = true if {i, j} is in E
+        inb.resize(V); // inb[v] = true if v is in the blossom being contracted
+        ed.resize(V); // ed[i][j] = true if {i, j} is in E
+        for (int i = 0; i < V; i++)
+            ed[i].assign(V, false);
     }
 
+    // Takes an edge from the removed ones or, if there is none, from the pool
+    // The pool grows by chunks, so edges never move in memory
+    Edge new_edge(){
+        if (freed){
+            Edge e = freed;
+            freed = freed->n;
+            return e;
+        }
+        if (chunk < pool.size() && top == pool[chunk].size())
+            chunk++, top = 0;
+        if (chunk == pool.size())
+            pool.emplace_back(max(2 * V, 1024));
+        return &pool[chunk][top++];
+    }
+
+    // Adds {u, v} to the graph without touching the matching
     void addEdge(int u, int v){
         if (!ed[u][v]){
-            top->v = v, top->n = adj[u], adj[u] = top++;
-            top->v = u, top->n = adj[v], adj[v] = top++;
+            Edge e = new_edge();
+            e->v = v, e->n = adj[u], adj[u] = e;
+            e = new_edge();
+            e->v = u, e->n = adj[v], adj[v] = e;
             ed[u][v] = ed[v][u] = true;
         }
     }
 
-    // Returns the least commom ancestor of u and v in a tree of same root
-    int LCA(int root, int u, int v){
-        vector<bool> inp; // inp[v] = true if v is in the path
-        inp.assign(inp.size(), false);
+    // Unlinks v from the adjacency list of u and keeps the edge to be reused
+    void unlink_edge(int u, int v){
+        for (Edge* e = &adj[u]; *e; e = &((*e)->n)){
+            if ((*e)->v == v){
+                Edge aux = *e;
+                *e = aux->n;
+                aux->n = freed, freed = aux;
+                return;
+            }
+        }
+    }
+
+    // Removes {u, v} from the graph without touching the matching
+    void removeEdge(int u, int v){
+        if (ed[u][v]){
+            unlink_edge(u, v);
+            unlink_edge(v, u);
+            ed[u][v] = ed[v][u] = false;
+        }
+    }
 
+    // Returns the least commom ancestor of u and v in the alternating forest
+    // Returns -1 if u and v are in trees of different roots
+    int LCA(int u, int v){
+        vector<bool> inp(V, false); // inp[v] = true if v is in the path
+
+        // The roots are the only free vertices in the forest
         while (true){
             u = base[u];
             inp[u] = true;
-            if (u == root)
+            if (match[u] == -1)
                 break;
             u = father[match[u]];
         }
@@ -61,6 +149,8 @@ public:
         while (true){
             if (inp[v = base[v]])
                 return v;
+            else if (match[v] == -1)
+                return -1;
             else
                 v = father[match[v]];
         }
@@ -78,8 +168,7 @@ public:
     }
     
     // Adjust the new graph with the contracted blossom
-    void blossom_contraction(int s, int u, int v) {
-        int lca = LCA(s, u, v); // least commom ancestor of u and v in tree s
+    void blossom_contraction(int lca, int u, int v) {
         inb.assign(inb.size(), 0);
 
         mark_blossom(lca, u);
@@ -114,12 +203,14 @@ public:
         inq[q[qh = qt = 0] = s] = true; // Puts every vertex in queue
         
         while (qh <= qt){ // While didn't pass queue's top
+            if (cancel && qh % 1024 == 1023 && cancel->load(memory_order_relaxed))
+                return -1;
             int u = q[qh++]; // Actual vertex
             for (Edge e = adj[u]; e; e = e->n){
                 int v = e->v; // Analysing edge {u, v}
                 if (base[u] != base[v] && match[u] != v) // Not in the same blossom nor mates
                     if ((v == s) || (match[v] != -1 && father[match[v]] != -1)) // Found a cycle
-                        blossom_contraction(s, u, v);
+                        blossom_contraction(LCA(u, v), u, v);
                     else if (father[v] == -1){ // v is not in the forest
                         father[v] = u; // v came from u
                         if (match[v] == -1) // v is a free vertex, we found an augmanting path
@@ -148,20 +239,194 @@ public:
         return t != -1;
     }
 
+    // Same search of find_augmenting_path, but the forest grows
+    // from every free vertex at once, so one search is enough
+    // to tell if the matching is maximum
+    // Returns true and the edge {x, y} that joins two trees
+    // if there is an augmenting path, or else returns false
+    bool find_augmenting_forest(int& x, int& y){
+        inq.assign(inq.size(), 0);
+        father.assign(father.size(), -1);
+
+        // Initialization: every free vertex is the root of a tree
+        qh = 0, qt = -1;
+        for (int i = 0; i < V; i++){
+            base[i] = i;
+            if (match[i] == -1)
+                inq[q[++qt] = i] = true;
+        }
+
+        while (qh <= qt){
+            int u = q[qh++];
+            for (Edge e = adj[u]; e; e = e->n){
+                int v = e->v;
+                if (base[u] != base[v] && match[u] != v){
+                    if (match[v] == -1 || father[match[v]] != -1){ // v is an even vertex
+                        int lca = LCA(u, v);
+                        if (lca != -1) // Found a cycle in the same tree
+                            blossom_contraction(lca, u, v);
+                        else{ // Different trees, we found an augmanting path
+                            x = u, y = v;
+                            return true;
+                        }
+                    }
+                    else if (father[v] == -1){ // v is not in the forest
+                        father[v] = u;
+                        if (!inq[match[v]])
+                            inq[q[++qt] = match[v]] = true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // Matches x to y and unrolls the paths from each of them to
+    // the root of its tree, as augment_path does with one tree
+    void augment_forest(int x, int y){
+        int mx = match[x], my = match[y];
+        match[x] = y;
+        match[y] = x;
+        augment_path(x, mx);
+        augment_path(y, my);
+    }
+
+    // Augments the matching if the forest search finds a path
+    // Returns 1 if the matching grew or else returns 0
+    int repair(){
+        int x, y;
+        if (!find_augmenting_forest(x, y))
+            return 0;
+        augment_forest(x, y);
+        return 1;
+    }
+
+    // Adds {u, v} to the graph and keeps the matching maximum
+    // The matching must be maximum before the call
+    // Returns the new number of matches
+    int insertEdge(int u, int v){
+        if (u == v || ed[u][v])
+            return match_counts;
+        addEdge(u, v);
+
+        // An augmenting path must use {u, v}, so a free
+        // endpoint is its extreme and the search starts there
+        if (match[u] == -1 && match[v] == -1){
+            match[u] = v;
+            match[v] = u;
+            match_counts++;
+        }
+        else if (match[u] == -1)
+            match_counts += augment_path(u, find_augmenting_path(u));
+        else if (match[v] == -1)
+            match_counts += augment_path(v, find_augmenting_path(v));
+        else
+            match_counts += repair();
+
+        return match_counts;
+    }
+
+    // Removes {u, v} from the graph and keeps the matching maximum
+    // The matching must be maximum before the call
+    // Returns the new number of matches
+    int deleteEdge(int u, int v){
+        if (!ed[u][v])
+            return match_counts;
+        removeEdge(u, v);
+
+        // Removing an unmatched edge keeps the matching maximum
+        if (match[u] == v){
+            match[u] = match[v] = -1;
+            match_counts--;
+            match_counts += repair();
+        }
+
+        return match_counts;
+    }
+
+    int matchingSize(){
+        return match_counts;
+    }
+
+    // Returns the mate of v or -1 if v is free
+    int mateOf(int v){
+        return match[v];
+    }
+
     // Converted recursive algorithm to iterative version for simplicity
     // Returns number of matches
     int edmondsBlossomAlgorithm(){ 
         // Every vertex begins unmatched
-        int match_counts = 0;
+        match_counts = 0;
         match.assign(match.size(), -1);
 
-        for (int u = 0; u < V; u++)
+        for (int u = 0; u < V; u++){
+            if (cancel && cancel->load(memory_order_relaxed))
+                break;
+            if (progress && u % 64 == 0)
+                progress(u, match_counts);
             if (match[u] == -1) // If u is a free vertex
                 match_counts += augment_path(u, find_augmenting_path(u));
+        }
         
         return match_counts;
     }
 
+    // Computes the Gallai-Edmonds partition from the forest of a failed search
+    // The matching must be maximum, so the search finds no augmenting path
+    // and the even vertices of the forest are D and the odd ones are A
+    Decomposition gallaiEdmonds(){
+        Decomposition dec;
+        int x, y;
+        dec.part.assign(V, 'C');
+        dec.odd_components = 0;
+        dec.certified = !find_augmenting_forest(x, y);
+
+        for (int v = 0; v < V; v++){
+            if (inq[v]) // Every even vertex was put in queue
+                dec.part[v] = 'D';
+            else if (father[v] != -1)
+                dec.part[v] = 'A';
+
+            if (dec.part[v] == 'D')
+                dec.D.push_back(v);
+            else if (dec.part[v] == 'A')
+                dec.A.push_back(v);
+            else
+                dec.C.push_back(v);
+        }
+
+        // Counting the odd components of G - A with a search
+        // that does not cross the vertices in A
+        vector<bool> seen(V, false);
+        vector<int> stack;
+        for (int s = 0; s < V; s++){
+            if (seen[s] || dec.part[s] == 'A')
+                continue;
+            int size = 0;
+            seen[s] = true;
+            stack.push_back(s);
+            while (!stack.empty()){
+                int u = stack.back();
+                stack.pop_back();
+                size++;
+                for (Edge e = adj[u]; e; e = e->n){
+                    if (!seen[e->v] && dec.part[e->v] != 'A'){
+                        seen[e->v] = true;
+                        stack.push_back(e->v);
+                    }
+                }
+            }
+            dec.odd_components += size % 2;
+        }
+
+        // Tutte-Berge formula: no matching is bigger than this bound
+        if (2 * match_counts != V + (int) dec.A.size() - dec.odd_components)
+            dec.certified = false;
+
+        return dec;
+    }
+
     void printMatching(){
         for (int i = 0; i < V; i++)
             if (i < match[i])
@@ -170,7 +435,550 @@ public:
 
 };
 
-int main(){
+// Reads the edges "u v" of a text file, one per line, with a buffer
+// Lines starting with '#' or '%' are comments
+class EdgeStream{
+    FILE* file;
+    vector<char> buffer;
+    size_t pos, len;
+
+    // Returns the next character or EOF
+    int next_char(){
+        if (pos == len){
+            len = fread(buffer.data(), 1, buffer.size(), file);
+            pos = 0;
+            if (len == 0)
+                return EOF;
+        }
+        return buffer[pos++];
+    }
+
+public:
+    EdgeStream(const char* path){
+        file = fopen(path, "rb");
+        buffer.resize(1 << 20);
+        pos = len = 0;
+    }
+
+    ~EdgeStream(){
+        if (file)
+            fclose(file);
+    }
+
+    bool isOpen(){
+        return file != NULL;
+    }
+
+    // Goes back to the first edge for one more pass
+    void rewind(){
+        fseek(file, 0, SEEK_SET);
+        pos = len = 0;
+    }
+
+    // Reads the next edge into {u, v}
+    // Returns false at the end of the file
+    bool next(long long& u, long long& v){
+        long long value[2];
+        int c = next_char();
+
+        for (int k = 0; k < 2; ){
+            if (c == EOF)
+                return false;
+            if ((c == '#' || c == '%') && k == 0){ // Skips the comment line
+                while (c != '\n' && c != EOF)
+                    c = next_char();
+            }
+            else if (c >= '0' && c <= '9'){
+                value[k] = 0;
+                while (c >= '0' && c <= '9'){
+                    value[k] = value[k] * 10 + (c - '0');
+                    c = next_char();
+                }
+                k++;
+                continue;
+            }
+            c = next_char();
+        }
+
+        // Ignores anything else in the line, like weights
+        while (c != '\n' && c != EOF)
+            c = next_char();
+
+        u = value[0], v = value[1];
+        return true;
+    }
+};
+
+// The edges {u, v} with u < v of a compressed graph (see graph_compressed.h),
+// with the interface of EdgeStream, so StreamMatching reads them from memory
+// The lists are decoded a block at a time
+class CompressedEdges{
+    const CompressedGraph& g;
+    uint64_t u;
+    ListCursor c;
+    uint32_t buffer[COMPRESSED_BLOCK], k, count;
+
+public:
+    CompressedEdges(const CompressedGraph& g) : g(g){
+        rewind();
+    }
+
+    void rewind(){
+        u = 0;
+        k = count = 0;
+        if (g.n)
+            c = g.cursor(0);
+    }
+
+    bool next(long long& a, long long& b){
+        while (u < g.n){
+            while (k < count){
+                uint32_t w = buffer[k++];
+                if (u < w){
+                    a = u, b = w;
+                    return true;
+                }
+            }
+            k = 0;
+            count = g.next_block(c, buffer);
+            if (!count && ++u < g.n)
+                c = g.cursor(u);
+        }
+        return false;
+    }
+};
+
+// Approximate matching for edge lists that do not fit in memory
+// Keeps only O(V) memory: the mates and one candidate per vertex
+// The first pass builds a maximal matching, that has at least half
+// of the edges of a maximum one, and each extra pass looks for
+// augmenting paths x - a = b - y of length 3 while reading the edges
+// Edges is EdgeStream, to read a file, or CompressedEdges
+class StreamMatching{
+    vector<long long> match, cand, claim;
+    long long match_counts;
+
+    // Vertices may show up in any order, so the arrays grow with them
+    void grow(long long v){
+        if (v >= (long long) match.size()){
+            match.resize(v + 1, -1);
+            cand.resize(v + 1, -1);
+            claim.resize(v + 1, -1);
+        }
+    }
+
+public:
+    StreamMatching(){
+        match_counts = 0;
+    }
+
+    // Greedy pass: matches every edge with two free ends
+    template <typename Edges>
+    void maximalPass(Edges& edges){
+        long long u, v;
+        while (edges.next(u, v)){
+            grow(max(u, v));
+            if (u != v && match[u] == -1 && match[v] == -1){
+                match[u] = v;
+                match[v] = u;
+                match_counts++;
+            }
+        }
+    }
+
+    // A free vertex x next to a matched vertex a becomes the candidate of a
+    // As soon as both ends of a matched edge {a, b} have candidates x and y,
+    // the path x - a = b - y is augmented
+    // Returns the number of augmenting paths found in the pass
+    template <typename Edges>
+    long long augmentingPass(Edges& edges){
+        long long u, v, found = 0;
+        cand.assign(cand.size(), -1);
+        claim.assign(claim.size(), -1);
+
+        while (edges.next(u, v)){
+            if (u == v)
+                continue;
+            for (int k = 0; k < 2; k++, swap(u, v)){
+                long long x = u, a = v; // x is free and a is matched
+                if (match[x] != -1 || match[a] == -1 || cand[a] != -1)
+                    continue;
+                long long b = match[a], y = cand[b];
+
+                // A free vertex is the candidate of one vertex at a time,
+                // but it moves to a if that closes a path
+                if (claim[x] != -1){
+                    if (y == -1 || y == x)
+                        continue;
+                    cand[claim[x]] = -1;
+                }
+                cand[a] = x, claim[x] = a;
+
+                if (y != -1){
+                    match[x] = a, match[a] = x;
+                    match[y] = b, match[b] = y;
+                    cand[a] = cand[b] = claim[x] = claim[y] = -1;
+                    match_counts++;
+                    found++;
+                }
+                break;
+            }
+        }
+
+        return found;
+    }
+
+    long long matchingSize(){
+        return match_counts;
+    }
+
+    // The matched vertices of a maximal matching cover every edge,
+    // so no matching is bigger than 2 * |M| nor than V / 2
+    long long upperBound(){
+        return min(2 * match_counts, (long long) match.size() / 2);
+    }
+};
+
+// Reads edges with 1 + passes passes and prints the size
+// of the matching and an upper bound
+template <typename Edges>
+void passMatching(Edges& edges, int passes){
+    StreamMatching sm;
+    sm.maximalPass(edges);
+    int done = 1;
+    while (done <= passes){
+        edges.rewind();
+        done++;
+        if (!sm.augmentingPass(edges)) // The next passes would find nothing
+            break;
+    }
+
+    cout << "Streaming Matching = " << sm.matchingSize() << "\n";
+    cout << "Upper bound = " << sm.upperBound() << "\n";
+    cout << "Passes = " << done << "\n";
+}
+
+// Streams the edge list in path with 1 + passes passes
+int streamMatching(const char* path, int passes){
+    EdgeStream edges(path);
+    if (!edges.isOpen()){
+        cout << "Could not open " << path << "\n";
+        return 1;
+    }
+
+    passMatching(edges, passes);
+
+    return 0;
+}
+
+// Compresses the lists of the binary CSR file in path (format NULL) or of
+// a file in one of the formats of graph_formats.h and matches them in
+// memory with 1 + passes passes, for graphs too big for the Blossom
+int compressedMatching(const char* format, const char* path, int passes){
+    CompressedGraph cg;
+    auto compress = [&](uint64_t n, const uint64_t* offsets, const uint32_t* neighbors){
+        Relabeling r;
+        if (!relabel_method.empty() && relabel_graph(relabel_method, n, offsets, neighbors, r)){
+            offsets = r.graph.offsets.data();
+            neighbors = r.graph.neighbors.data();
+        }
+        cg.build(n, offsets, neighbors);
+    };
+
+    if (format){
+        CsrGraph g;
+        if (!read_graph_file(format, path, g)){
+            cout << "Could not load " << path << "\n";
+            return 1;
+        }
+        compress(g.n, g.offsets.data(), g.neighbors.data());
+    }
+    else{
+        csr_graph g;
+        if (csr_open(path, &g)){
+            cout << "Could not load " << path << "\n";
+            return 1;
+        }
+        compress(g.n, g.offsets, g.neighbors);
+        csr_close(&g);
+    }
+    cg.report();
+
+    CompressedEdges edges(cg);
+    passMatching(edges, passes);
+
+    return 0;
+}
+
+// Runs task(i, thread) for i from 0 to tasks - 1 in threads threads
+// Each thread takes the next task as soon as it finishes one
+void run_parallel(int tasks, int threads, function<void(int, int)> task){
+    atomic<int> next(0);
+    vector<thread> pool;
+
+    auto worker = [&](int t){
+        for (int i = next++; i < tasks; i = next++)
+            task(i, t);
+    };
+
+    for (int t = 1; t < threads; t++)
+        pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : pool)
+        th.join();
+}
+
+// Implementation of union-find algorithm with path halving
+int find(vector<int>& parent, int i){
+    while (parent[i] != i)
+        i = parent[i] = parent[parent[i]];
+    return i;
+}
+
+// Finds a maximum matching of the graph with V vertices and edges
+// solving its connected components at the same time in threads threads
+// Components smaller than batch vertices are packed together,
+// so each task has at least about batch vertices
+// mate receives the matching and the number of matches is returned
+int parallelMatching(int V, const vector<pair<int, int>>& edges, vector<int>& mate, int threads, int batch = 256){
+    vector<int> parent(V);
+    for (int i = 0; i < V; i++)
+        parent[i] = i;
+    for (auto& e : edges)
+        parent[find(parent, e.second)] = find(parent, e.first);
+
+    // Vertices of each component, biggest components first
+    vector<vector<int>> components(V);
+    for (int v = 0; v < V; v++)
+        components[find(parent, v)].push_back(v);
+    sort(components.begin(), components.end(), [](const vector<int>& a, const vector<int>& b){
+        return a.size() > b.size();
+    });
+    while (!components.empty() && components.back().empty())
+        components.pop_back();
+
+    // Next fit decreasing: a bin is closed when the next component does not fit
+    // Components bigger than batch stay alone in their bins
+    vector<vector<int>> bins;
+    for (auto& c : components){
+        if (bins.empty() || bins.back().size() + c.size() > (size_t) batch)
+            bins.emplace_back();
+        bins.back().insert(bins.back().end(), c.begin(), c.end());
+    }
+
+    // local[v] is the number of v inside its bin
+    vector<int> bin_of(V), local(V);
+    vector<vector<pair<int, int>>> bin_edges(bins.size());
+    for (int b = 0; b < (int) bins.size(); b++)
+        for (int i = 0; i < (int) bins[b].size(); i++)
+            bin_of[bins[b][i]] = b, local[bins[b][i]] = i;
+    for (auto& e : edges)
+        bin_edges[bin_of[e.first]].push_back({local[e.first], local[e.second]});
+
+    vector<Blossom> solvers(threads, Blossom(0));
+    atomic<int> match_counts(0);
+    mate.assign(V, -1);
+
+    run_parallel(bins.size(), threads, [&](int b, int t){
+        Blossom& bm = solvers[t];
+        bm.reset(bins[b].size());
+        for (auto& e : bin_edges[b])
+            bm.addEdge(e.first, e.second);
+        match_counts += bm.edmondsBlossomAlgorithm();
+        for (int i = 0; i < (int) bins[b].size(); i++)
+            if (bm.mateOf(i) != -1)
+                mate[bins[b][i]] = bins[b][bm.mateOf(i)];
+    });
+
+    return match_counts;
+}
+
+// Reads the number of vertices and the adjacency matrix of a graph
+// Returns 1 for a graph, 0 if there is no graph left in the input
+// and -1 if the vertex count is negative or the matrix is truncated
+int read_graph(istream& in, int& V, vector<pair<int, int>>& edges){
+    if (!(in >> V))
+        return in.eof() ? 0 : -1;
+    if (V < 0)
+        return -1;
+    edges.clear();
+    for (int i = 0; i < V; i++){
+        for (int j = 0; j < V; j++){
+            int a;
+            if (!(in >> a))
+                return -1;
+            if (a && i < j)
+                edges.push_back({i, j});
+        }
+    }
+    return 1;
+}
+
+// Prints the pairs of the matching in mate as printMatching does
+void print_mates(const vector<int>& mate){
+    for (int i = 0; i < (int) mate.size(); i++)
+        if (i < mate[i])
+            cout << i + 1 << " " << mate[i] + 1 << "\n";
+}
+
+// Reads one graph as an adjacency matrix and matches its components in parallel
+int componentsMatching(int threads){
+    int V;
+    vector<pair<int, int>> edges;
+    vector<int> mate;
+    int status = read_graph(cin, V, edges);
+    if (status < 0)
+        cout << "Invalid adjacency matrix\n";
+    if (status <= 0)
+        return 1;
+
+    cout << "Total Matching = " << parallelMatching(V, edges, mate, threads) << "\n";
+    print_mates(mate);
+
+    return 0;
+}
+
+// Reads adjacency matrices until the end of the input and matches
+// them in parallel, window by window, printing them in input order
+// Each thread keeps its Blossom, so its buffers are reused
+// An invalid matrix ends the batch after the graphs read before it
+int batchMatching(int threads){
+    const int window = 1024;
+    vector<Blossom> solvers(threads, Blossom(0));
+    vector<int> sizes(window), results(window);
+    vector<vector<pair<int, int>>> graphs(window);
+    vector<vector<int>> mates(window);
+    int count = 0, status = 1;
+
+    while (status > 0){
+        int n = 0;
+        while (n < window && (status = read_graph(cin, sizes[n], graphs[n])) > 0)
+            n++;
+        if (!n)
+            break;
+
+        run_parallel(n, threads, [&](int g, int t){
+            Blossom& bm = solvers[t];
+            bm.reset(sizes[g]);
+            for (auto& e : graphs[g])
+                bm.addEdge(e.first, e.second);
+            results[g] = bm.edmondsBlossomAlgorithm();
+            mates[g].resize(sizes[g]);
+            for (int i = 0; i < sizes[g]; i++)
+                mates[g][i] = bm.mateOf(i);
+        });
+
+        for (int g = 0; g < n; g++){
+            cout << "Graph " << ++count << ": Total Matching = " << results[g] << "\n";
+            print_mates(mates[g]);
+        }
+    }
+
+    if (status < 0){
+        cout << "Graph " << count + 1 << ": Invalid adjacency matrix\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Finds and prints a maximum matching of a CSR graph with n vertices
+// With relabel_method set the Blossom gets the relabeled graph
+// (see graph_relabel.h) and the pairs are printed with the input numbers
+void csr_matching(uint64_t n, const uint64_t* offsets, const uint32_t* neighbors){
+    Relabeling r;
+    if (!relabel_method.empty() && relabel_graph(relabel_method, n, offsets, neighbors, r)){
+        offsets = r.graph.offsets.data();
+        neighbors = r.graph.neighbors.data();
+    }
+
+    Blossom bm(n);
+    for (uint64_t u = 0; u < n; u++)
+        for (uint64_t k = offsets[u]; k < offsets[u + 1]; k++)
+            if (u < neighbors[k])
+                bm.addEdge(u, neighbors[k]);
+
+    cout << "Total Matching = " << bm.edmondsBlossomAlgorithm() << "\n";
+    if (r.old_of.empty()){
+        bm.printMatching();
+        return;
+    }
+
+    vector<int> mate(n, -1);
+    for (uint64_t u = 0; u < n; u++)
+        if (bm.mateOf(u) != -1)
+            mate[r.old_of[u]] = r.old_of[bm.mateOf(u)];
+    print_mates(mate);
+}
+
+// Finds a maximum matching of the binary CSR file in path (see graph_csr.h)
+// The neighbors go straight from the mapped file to the Blossom
+int csrMatching(const char* path){
+    csr_graph g;
+    if (csr_open(path, &g)){
+        cout << "Could not load " << path << "\n";
+        return 1;
+    }
+
+    csr_matching(g.n, g.offsets, g.neighbors);
+    csr_close(&g);
+
+    return 0;
+}
+
+// Finds a maximum matching of a file in one of the formats of graph_formats.h
+int formatMatching(const char* format, const char* path){
+    CsrGraph g;
+    if (!read_graph_file(format, path, g)){
+        cout << "Could not load " << path << "\n";
+        return 1;
+    }
+
+    csr_matching(g.n, g.offsets.data(), g.neighbors.data());
+
+    return 0;
+}
+
+#ifndef NO_MAIN
+// With "file.csr" finds a maximum matching of a binary CSR file
+// With "--dimacs", "--metis", "--mtx" or "--snap" and a file finds
+// a maximum matching of a file in that format
+// With "--stream file [passes]" finds an approximate matching of the
+// edge list in file without loading it
+// With "--compressed file.csr [passes]" or "--compressed --snap file [passes]"
+// (or another format) finds it the same way over compressed lists in memory
+// With "--components [threads]" reads an adjacency matrix and
+// matches its connected components in parallel
+// With "--batch [threads]" reads many adjacency matrices and
+// matches them in parallel
+// "--relabel degree|rcm|bfs" renumbers the vertices of a file first
+// Otherwise runs the example
+int main(int argc, char* argv[]){
+    argc = relabel_options(argc, argv, relabel_method);
+    if (!relabel_method.empty() && !relabel_known(relabel_method)){
+        cout << "Unknown relabeling " << relabel_method << ", use degree, rcm or bfs\n";
+        return 1;
+    }
+
+    int threads = thread::hardware_concurrency();
+    if (argc >= 3)
+        threads = atoi(argv[2]);
+    threads = max(threads, 1);
+
+    if (argc >= 3 && !strcmp(argv[1], "--stream"))
+        return streamMatching(argv[2], argc >= 4 ? atoi(argv[3]) : 0);
+    if (argc >= 4 && !strcmp(argv[1], "--compressed") && argv[2][0] == '-')
+        return compressedMatching(argv[2] + 2, argv[3], argc >= 5 ? atoi(argv[4]) : 0);
+    if (argc >= 3 && !strcmp(argv[1], "--compressed"))
+        return compressedMatching(NULL, argv[2], argc >= 4 ? atoi(argv[3]) : 0);
+    if (argc >= 2 && !strcmp(argv[1], "--components"))
+        return componentsMatching(threads);
+    if (argc >= 2 && !strcmp(argv[1], "--batch"))
+        return batchMatching(threads);
+    if (argc >= 2 && argv[1][0] != '-')
+        return csrMatching(argv[1]);
+    if (argc >= 3)
+        return formatMatching(argv[1] + 2, argv[2]);
+
     int graph[8][8] = {
         {0, 1, 0, 0, 0, 0, 0, 0},
         {1, 0, 1, 1, 0, 0, 0, 0},
@@ -198,5 +1006,26 @@ int main(){
         bm.printMatching();
     }
 
+    // The witness A proves that the matching is maximum
+    Decomposition dec = bm.gallaiEdmonds();
+    cout << "D = {";
+    for (int i = 0; i < (int) dec.D.size(); i++)
+        cout << (i ? ", " : "") << dec.D[i] + 1;
+    cout << "}, A = {";
+    for (int i = 0; i < (int) dec.A.size(); i++)
+        cout << (i ? ", " : "") << dec.A[i] + 1;
+    cout << "}, C = {";
+    for (int i = 0; i < (int) dec.C.size(); i++)
+        cout << (i ? ", " : "") << dec.C[i] + 1;
+    cout << "}\n";
+    cout << "Tutte-Berge certificate: " << (dec.certified ? "valid" : "invalid") << "\n";
+
+    // Updating the graph keeps the matching maximum
+    bm.deleteEdge(0, 1);
+    bm.insertEdge(0, 2);
+    cout << "After removing {1, 2} and inserting {1, 3}, Total Matching = " << bm.matchingSize() << "\n";
+    bm.printMatching();
+
     return 0;
 }
+#endif
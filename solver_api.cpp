@@ -0,0 +1,182 @@
+// The tools behind solver_api.h, compiled once for the programs that use it
+
+#include <iostream>
+#include <set>
+#include <map>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <future>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+
+#include "graph_csr.h"
+#include "graph_formats.h"
+#include "graph_relabel.h"
+#include "graph_compressed.h"
+#include "solver_api.h"
+
+// The clique tool brings the independent set tool, and it brings the
+// matching, all without their main functions and out of the way of the
+// names of the program
+#define NO_MAIN
+namespace tools {
+#include "maximum_clique.cpp"
+}
+#undef NO_MAIN
+
+struct SolverContext::State {
+	tools::MisSearch mis;
+	tools::CliqueSearch clique;
+	tools::matching::Blossom blossom{0};
+};
+
+SolverContext::SolverContext() : state(new State()) {}
+SolverContext::~SolverContext() = default;
+SolverContext::SolverContext(SolverContext&& other) noexcept = default;
+SolverContext& SolverContext::operator=(SolverContext&& other) noexcept = default;
+
+// Milliseconds since start
+static double elapsed(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+SolveResult SolverContext::independent_set(const CsrGraph& g, const SolveOptions& options) {
+	auto start = std::chrono::steady_clock::now();
+	tools::MisSearch& search = state->mis;
+	search.set_graph(g.n, g.offsets.data(), g.neighbors.data());
+	search.cancel_flag = options.cancel.watched() ? options.cancel.get() : NULL;
+	search.search_progress = options.progress;
+	search.progress_interval = options.interval;
+	search.bitset_limit = std::max(1, std::min(options.bitset_limit, BITSET_LIMIT));
+
+	std::set<int> X;
+	for (int v = 0; v < search.N_vertices; v++)
+		X.insert(v);
+	std::set<int> S = search.MIS(X);
+	search.cancel_flag = NULL; // Of this call only
+	search.search_progress = nullptr;
+
+	SolveResult r;
+	r.set.assign(S.begin(), S.end());
+	r.bound = search.search_bound;
+	r.cancelled = search.search_cancelled;
+	r.nodes = search.search_nodes;
+	r.ms = elapsed(start);
+	return r;
+}
+
+SolveResult SolverContext::clique(const CsrGraph& g, const SolveOptions& options) {
+	auto start = std::chrono::steady_clock::now();
+	tools::CliqueSearch& clique = state->clique;
+	tools::MisSearch& search = clique.mis;
+	search.set_graph(g.n, g.offsets.data(), g.neighbors.data());
+	search.cancel_flag = options.cancel.watched() ? options.cancel.get() : NULL;
+	search.search_progress = options.progress;
+	search.progress_interval = options.interval;
+	search.bitset_limit = std::max(1, std::min(options.bitset_limit, BITSET_LIMIT));
+
+	std::set<int> S = clique.maximum_clique();
+	search.cancel_flag = NULL;
+	search.search_progress = nullptr;
+
+	SolveResult r;
+	r.set.assign(S.begin(), S.end());
+	r.bound = search.search_bound;
+	r.cancelled = search.search_cancelled;
+	r.nodes = search.search_nodes;
+	r.ms = elapsed(start);
+	return r;
+}
+
+SolveResult SolverContext::matching(const CsrGraph& g, const SolveOptions& options) {
+	auto start = std::chrono::steady_clock::now();
+	tools::matching::Blossom& bm = state->blossom;
+	bm.reset(g.n);
+	for (uint64_t u = 0; u < g.n; u++)
+		for (uint64_t k = g.offsets[u]; k < g.offsets[u + 1]; k++)
+			if (u < g.neighbors[k])
+				bm.addEdge(u, g.neighbors[k]);
+
+	auto last = start;
+	bm.cancel = options.cancel.get();
+	bm.progress = [&](int searched, int matches) {
+		auto now = std::chrono::steady_clock::now();
+		if (options.progress && now - last >= std::chrono::duration<double, std::milli>(options.interval)) {
+			options.progress(searched, matches);
+			last = now;
+		}
+	};
+
+	SolveResult r;
+	int size = bm.edmondsBlossomAlgorithm();
+	bm.cancel = NULL;
+	bm.progress = nullptr;
+	for (uint64_t u = 0; u < g.n; u++)
+		if ((int) u < bm.mateOf(u))
+			r.edges.emplace_back(u, bm.mateOf(u));
+	// No matching has more than n / 2 edges
+	r.cancelled = options.cancel.cancelled();
+	r.bound = r.cancelled ? g.n / 2 : size;
+	r.ms = elapsed(start);
+	return r;
+}
+
+// Contexts of the finished solves of a Solver, which the next ones take,
+// so there are as many as solves ever ran at the same time
+struct ContextPool {
+	std::mutex lock;
+	std::vector<std::unique_ptr<SolverContext>> idle;
+
+	std::unique_ptr<SolverContext> take() {
+		std::lock_guard<std::mutex> guard(lock);
+		if (idle.empty())
+			return std::unique_ptr<SolverContext>(new SolverContext());
+		std::unique_ptr<SolverContext> context = std::move(idle.back());
+		idle.pop_back();
+		return context;
+	}
+
+	void give(std::unique_ptr<SolverContext> context) {
+		std::lock_guard<std::mutex> guard(lock);
+		idle.push_back(std::move(context));
+	}
+};
+
+typedef SolveResult (SolverContext::*ContextSolve)(const CsrGraph&, const SolveOptions&);
+
+// Runs solve on g in a thread of its own with a context of the pool
+static std::future<SolveResult> solve_async(std::shared_ptr<const CsrGraph> g, std::shared_ptr<ContextPool> pool,
+	SolveOptions options, ContextSolve solve) {
+	return std::async(std::launch::async, [g, pool, options, solve]() {
+		std::unique_ptr<SolverContext> context = pool->take();
+		SolveResult r = ((*context).*solve)(*g, options);
+		pool->give(std::move(context));
+		return r;
+	});
+}
+
+Solver::Solver(CsrGraph g) : graph(std::make_shared<const CsrGraph>(std::move(g))), contexts(std::make_shared<ContextPool>()) {}
+
+std::future<SolveResult> Solver::independent_set(SolveOptions options) const {
+	return solve_async(graph, contexts, options, &SolverContext::independent_set);
+}
+
+std::future<SolveResult> Solver::clique(SolveOptions options) const {
+	return solve_async(graph, contexts, options, &SolverContext::clique);
+}
+
+std::future<SolveResult> Solver::matching(SolveOptions options) const {
+	return solve_async(graph, contexts, options, &SolverContext::matching);
+}
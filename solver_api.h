@@ -0,0 +1,138 @@
+#ifndef SOLVER_API_H
+#define SOLVER_API_H
+
+// Solves of the independent set, clique and matching tools, to embed them
+// in a program
+//
+// The tools are compiled in solver_api.cpp, so a program includes this
+// header in any number of its files and is built with solver_api.cpp
+// and -pthread:
+//
+//   g++ -O2 -std=c++17 -pthread program.cpp solver_api.cpp -o program
+//
+// A SolverContext holds the state of the searches and the Blossom of the
+// matching, and keeps their buffers from one solve to the next, so a
+// thread that solves many graphs only allocates them for bigger ones.
+// A context solves one graph at a time, and contexts share nothing, so
+// each thread has its own
+//
+// A Solver keeps its graph, and each solve runs in a thread of its own and
+// gives its result in a future. The solves take a context from the Solver
+// and give it back when they end, so the next solves find it warm
+//
+// A CancelToken stops the solves it is given to from any thread: the
+// independent set and clique searches give the best set they found and an
+// upper bound, and the matching gives the edges it matched so far.
+// The progress callback is called from the thread of the solve every
+// interval milliseconds, with the nodes of the search (the vertices
+// searched from, for the matching) and the size of the best answer so far
+//
+//   Solver solver(csr);
+//   CancelToken token;
+//   std::future<SolveResult> f = solver.independent_set({token, report});
+//   ...
+//   token.cancel();
+//   SolveResult r = f.get(); // r.cancelled, r.set and r.bound
+
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <utility>
+#include <cstdint>
+
+#include "graph_formats.h"
+
+// Cancels the solves it is given to, copies share the same flag
+class CancelToken {
+	std::shared_ptr<std::atomic<bool>> flag = std::make_shared<std::atomic<bool>>(false);
+
+public:
+	void cancel() {
+		*flag = true;
+	}
+
+	bool cancelled() const {
+		return *flag;
+	}
+
+	const std::atomic<bool>* get() const {
+		return flag.get();
+	}
+
+	// Returns false if there is no other copy left to cancel it
+	bool watched() const {
+		return flag.use_count() > 1;
+	}
+};
+
+typedef std::function<void(long long nodes, int best)> ProgressCallback;
+
+struct SolveOptions {
+	CancelToken cancel;
+	ProgressCallback progress; // Empty for none
+	double interval = 100; // Milliseconds between calls of progress
+	// Vertices of the biggest subproblems the searches solve with bitsets,
+	// from 1 to 512, and at most 64 with progress or a token that can
+	// still be cancelled, since a bitset search doesn't stop
+	int bitset_limit = 128;
+};
+
+struct SolveResult {
+	std::vector<int> set; // Independent set or clique, sorted
+	std::vector<std::pair<int, int>> edges; // Matching, as u < v
+	int bound = 0; // Upper bound of the size of the answer
+	bool cancelled = false; // The answer may not be the best one
+	long long nodes = 0; // Nodes of the searches, 0 for the matching
+	double ms = 0;
+};
+
+// State of the solves of one thread
+class SolverContext {
+	struct State;
+	std::unique_ptr<State> state;
+
+public:
+	SolverContext();
+	~SolverContext();
+	SolverContext(SolverContext&& other) noexcept;
+	SolverContext& operator=(SolverContext&& other) noexcept;
+
+	// Maximum independent set
+	SolveResult independent_set(const CsrGraph& g, const SolveOptions& options = SolveOptions());
+
+	// Maximum clique
+	SolveResult clique(const CsrGraph& g, const SolveOptions& options = SolveOptions());
+
+	// Maximum matching
+	SolveResult matching(const CsrGraph& g, const SolveOptions& options = SolveOptions());
+};
+
+// Contexts of the solves of a Solver, see solver_api.cpp
+struct ContextPool;
+
+// Keeps the graph and the contexts of its solves, which share them,
+// so it can be destroyed before they end
+class Solver {
+	std::shared_ptr<const CsrGraph> graph;
+	std::shared_ptr<ContextPool> contexts;
+
+public:
+	Solver(CsrGraph g);
+
+	uint64_t vertices() const {
+		return graph->n;
+	}
+
+	// Maximum independent set
+	std::future<SolveResult> independent_set(SolveOptions options = SolveOptions()) const;
+
+	// Maximum clique
+	std::future<SolveResult> clique(SolveOptions options = SolveOptions()) const;
+
+	// Maximum matching
+	std::future<SolveResult> matching(SolveOptions options = SolveOptions()) const;
+};
+
+#endif
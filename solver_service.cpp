@@ -0,0 +1,476 @@
+// Long-running service for the algorithms of the repository, so a pipeline
+// that solves many small graphs doesn't pay the startup of a tool for each one
+//
+// Compile with: g++ -O2 -std=c++17 -pthread solver_service.cpp solver_api.cpp -o solver_service
+// Run with: ./solver_service [--threads N] [--socket PATH]
+//
+// Requests come in batches, from stdin or from each client of the Unix
+// socket PATH, one client at a time. A batch is "batch K" and K requests,
+// each one an operation, an id (a word) and its graphs, each graph as the
+// number of vertices and the adjacency matrix, as the tools read them:
+//
+//   mis ID G          maximum independent set
+//   clique ID G       maximum clique
+//   chordal ID G      1 if G is chordal, 0 if not
+//   chordalize ID G   fill in edges of a minimal elimination order
+//   matching ID G     maximum matching
+//   product ID G H    cartesian product G x H
+//
+// The requests of a batch run at the same time in the threads of the pool,
+// which live as long as the service, and so do their solver contexts
+// (see solver_api.h), so their buffers are only allocated for bigger graphs.
+// A batch is read and solved in windows of up to WINDOW_REQUESTS requests
+// and WINDOW_BYTES of matrices, and each window is freed once answered,
+// so a big batch doesn't have to fit in memory at once.
+// The answers come in the order of the batch, one line each, and then
+// the time of the whole batch:
+//
+//   ID OPERATION MILLISECONDS SIZE [ITEMS]
+//   done K MILLISECONDS
+//
+// SIZE is the number of vertices of the set or clique, of edges of the
+// matching, fill in or product, or 1 or 0 for chordal. ITEMS are the
+// vertices, from 0, or the edges as u,v. "quit" stops the service
+//
+// A malformed request gets "ID error MESSAGE" (a bad batch line gets
+// "- error MESSAGE"). Where the requests after it start can't be known,
+// so the requests before it are answered, then the error and the done
+// line, and the input is skipped up to the next "batch" or "quit"
+// Graphs have at most REQUEST_VERTICES vertices, and so do products
+
+#include <iostream>
+#include <fstream>
+#include <set>
+#include <map>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "graph_csr.h"
+#include "graph_formats.h"
+#include "graph_relabel.h"
+#include "graph_compressed.h"
+
+// The independent set, clique and matching tools come from the API,
+// the others are compiled here without their main functions, each in
+// its own namespace
+#include "solver_api.h"
+#define REQUEST_VERTICES 8192 // Vertices of a graph, its matrix takes 256 MB
+#define BATCH_REQUESTS (1 << 20) // Requests of a batch
+#define WINDOW_REQUESTS 1024 // Requests solved at the same time
+#define WINDOW_BYTES ((size_t) 1 << 30) // Matrices of the requests of a window
+
+#define NO_MAIN
+namespace chordal {
+#include "check_cordability.cpp"
+}
+namespace fill {
+#include "chordalization.c"
+}
+namespace product {
+#include "cartesian_product.c"
+}
+#undef NO_MAIN
+
+// Graph of a request as the tools read it from stdin
+struct Graph {
+	int n = 0;
+	std::vector<int> M; // M[i*n + j] = 1 if {i, j} is an edge
+};
+
+struct Request {
+	std::string op, id;
+	Graph G, H; // H only for product
+	std::string result; // The answer line without the id and the operation
+	double ms = 0;
+};
+
+// Reads the words and numbers of the requests from a file with a buffer
+class RequestReader {
+	FILE* file;
+	std::vector<char> buffer;
+	size_t pos = 0, len = 0;
+	std::string pending; // Word given back by unread
+	bool has_pending = false;
+
+	// Returns the next character or EOF
+	int next_char() {
+		if (pos == len) {
+			len = fread(buffer.data(), 1, buffer.size(), file);
+			pos = 0;
+			if (len == 0)
+				return EOF;
+		}
+		return buffer[pos++];
+	}
+
+public:
+	RequestReader(FILE* file) : file(file), buffer(1 << 16) {}
+
+	// Makes w the next word again
+	void unread(const std::string& w) {
+		pending = w;
+		has_pending = true;
+	}
+
+	// Reads the next word into w
+	// Returns false at the end of the file
+	bool word(std::string& w) {
+		if (has_pending) {
+			w = pending;
+			has_pending = false;
+			return true;
+		}
+		int c = next_char();
+		while (c != EOF && isspace(c))
+			c = next_char();
+		if (c == EOF)
+			return false;
+
+		w.clear();
+		while (c != EOF && !isspace(c)) {
+			w += c;
+			c = next_char();
+		}
+		return true;
+	}
+
+	// Reads the next word as a number into x
+	// Returns false if it is not one
+	bool number(long long& x) {
+		std::string w;
+		if (!word(w) || w.empty())
+			return false;
+		char* end;
+		x = strtoll(w.c_str(), &end, 10);
+		return *end == 0;
+	}
+
+	// Reads a graph, the number of vertices and the adjacency matrix
+	// Returns false if it ends before the matrix does
+	bool graph(Graph& g) {
+		long long n, a;
+		if (!number(n) || n < 0 || n > REQUEST_VERTICES)
+			return false;
+		g.n = n;
+		g.M.assign((size_t) n * n, 0);
+		for (size_t k = 0; k < g.M.size(); k++) {
+			if (!number(a))
+				return false;
+			g.M[k] = a != 0;
+		}
+		return true;
+	}
+};
+
+// Threads that live as long as the service and run the tasks of each batch
+// The thread that calls run works as thread 0, and run returns when every
+// worker is done with the batch, so none of them sees the next one early
+class WorkerPool {
+	std::vector<std::thread> workers;
+	std::mutex lock;
+	std::condition_variable wake, idle;
+	std::function<void(int, int)> task;
+	std::atomic<int> next;
+	int tasks = 0, finished = 0; // Workers done with the batch
+	long long batch = 0; // Each batch wakes the workers once
+	bool stop = false;
+
+	// Runs tasks until there are none left in the batch
+	void work(int t) {
+		for (int i = next++; i < tasks; i = next++)
+			task(i, t);
+	}
+
+public:
+	int threads;
+
+	WorkerPool(int count) : next(0), threads(count) {
+		for (int t = 1; t < count; t++)
+			workers.emplace_back([this, t]() {
+				long long seen = 0;
+				std::unique_lock<std::mutex> guard(lock);
+				while (true) {
+					wake.wait(guard, [&]() { return stop || batch != seen; });
+					if (stop)
+						return;
+					seen = batch;
+					guard.unlock();
+					work(t);
+					guard.lock();
+					if (++finished == threads - 1)
+						idle.notify_all();
+				}
+			});
+	}
+
+	~WorkerPool() {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			stop = true;
+		}
+		wake.notify_all();
+		for (auto& w : workers)
+			w.join();
+	}
+
+	// Runs f(i, thread) for i from 0 to count - 1 and waits for all of them
+	void run(int count, std::function<void(int, int)> f) {
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			task = f;
+			tasks = count;
+			next = 0;
+			finished = 0;
+			batch++;
+		}
+		wake.notify_all();
+		work(0);
+
+		std::unique_lock<std::mutex> guard(lock);
+		idle.wait(guard, [&]() { return finished == threads - 1; });
+	}
+};
+
+// Writes the CSR lists of g, without loops
+void lists_of(const Graph& g, CsrGraph& csr) {
+	csr.n = g.n;
+	csr.offsets.assign(g.n + 1, 0);
+	csr.neighbors.clear();
+	for (int i = 0; i < g.n; i++) {
+		for (int j = 0; j < g.n; j++)
+			if (g.M[(size_t) i * g.n + j] && i != j)
+				csr.neighbors.push_back(j);
+		csr.offsets[i + 1] = csr.neighbors.size();
+	}
+}
+
+// Writes the size of a set and its vertices
+std::string set_result(const std::vector<int>& S) {
+	std::string r = std::to_string(S.size());
+	for (int v : S)
+		r += " " + std::to_string(v);
+	return r;
+}
+
+// Writes the number of edges u < v of the matrix M with n vertices
+// that are not in the matrix G (NULL for none), and the edges
+std::string edges_result(const int* M, int n, const int* G) {
+	std::string edges;
+	long long count = 0;
+	for (int u = 0; u < n; u++)
+		for (int v = u + 1; v < n; v++)
+			if (M[(size_t) u * n + v] && !(G && G[(size_t) u * n + v])) {
+				edges += " " + std::to_string(u) + "," + std::to_string(v);
+				count++;
+			}
+	return std::to_string(count) + edges;
+}
+
+std::vector<SolverContext> contexts; // One for each thread of the pool
+
+// Solves the request r in the thread t of the pool
+void solve(Request& r, int t) {
+	auto start = std::chrono::steady_clock::now();
+	Graph& g = r.G;
+
+	if (r.op == "mis" || r.op == "clique" || r.op == "matching") {
+		CsrGraph csr;
+		lists_of(g, csr);
+		if (r.op == "mis")
+			r.result = set_result(contexts[t].independent_set(csr).set);
+		else if (r.op == "clique")
+			r.result = set_result(contexts[t].clique(csr).set);
+		else {
+			SolveResult m = contexts[t].matching(csr);
+			r.result = std::to_string(m.edges.size());
+			for (auto& e : m.edges)
+				r.result += " " + std::to_string(e.first) + "," + std::to_string(e.second);
+		}
+	}
+	else if (r.op == "chordal") {
+		// The linear test only reads the lists, it has no global state
+		CsrGraph csr;
+		lists_of(g, csr);
+		r.result = chordal::is_chordal(CsrView{csr.n, csr.offsets.data(), csr.neighbors.data()}) ? "1" : "0";
+	}
+	else if (r.op == "chordalize") {
+		fill::order ord = fill::max_card_search(g.M.data(), g.n);
+		int* H = fill::fill_in(g.M.data(), g.n, ord);
+		r.result = H ? edges_result(H, g.n, g.M.data()) : "error out of memory";
+		free(H);
+		free(ord.ord);
+		free(ord.vert);
+	}
+	else if (r.op == "product") {
+		// serve checks that the product has at most REQUEST_VERTICES vertices
+		long long n = (long long) g.n * r.H.n;
+		int* P = product::cartProd(g.M.data(), r.H.M.data(), g.n, r.H.n);
+		r.result = P ? edges_result(P, n, NULL) : "error out of memory";
+		free(P);
+	}
+
+	r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Skips the words of reader up to the next "batch" or "quit",
+// which is read again by the next call of word
+void skip_to_batch(RequestReader& reader) {
+	std::string w;
+	while (reader.word(w))
+		if (w == "batch" || w == "quit") {
+			reader.unread(w);
+			return;
+		}
+}
+
+// Answers the batches of in on out until the end of in or "quit"
+// Returns false if it got "quit"
+bool serve(FILE* in, FILE* out, WorkerPool& pool) {
+	RequestReader reader(in);
+	std::vector<Request> requests;
+	std::string w;
+
+	for (bool more = reader.word(w); more; more = reader.word(w)) {
+		if (w == "quit")
+			return false;
+		long long count;
+		if (w != "batch" || !reader.number(count) || count < 0 || count > BATCH_REQUESTS) {
+			fprintf(out, "- error expected batch K, with K up to %d\n", BATCH_REQUESTS);
+			fflush(out);
+			skip_to_batch(reader);
+			continue;
+		}
+
+		// A malformed request ends the batch, since the rest can't be found
+		std::string error;
+		long long answered = 0;
+		double ms = 0;
+		while (answered < count && error.empty()) {
+			// The window takes at least one request, whatever its size
+			size_t bytes = 0;
+			int ready = 0;
+			while (ready < WINDOW_REQUESTS && answered + ready < count && bytes < WINDOW_BYTES) {
+				if ((int) requests.size() == ready)
+					requests.emplace_back();
+				Request& r = requests[ready];
+				if (!reader.word(r.op) || !reader.word(r.id)) {
+					error = "- error the batch ends before request " + std::to_string(answered + ready + 1);
+					break;
+				}
+				if (r.op != "mis" && r.op != "clique" && r.op != "chordal" && r.op != "chordalize"
+					&& r.op != "matching" && r.op != "product") {
+					error = r.id + " error unknown operation " + r.op;
+					break;
+				}
+				if (!reader.graph(r.G) || (r.op == "product" && !reader.graph(r.H))) {
+					error = r.id + " error bad graph, or more than " + std::to_string(REQUEST_VERTICES) + " vertices";
+					break;
+				}
+				if (r.op == "product" && (long long) r.G.n * r.H.n > REQUEST_VERTICES) {
+					error = r.id + " error the product has more than " + std::to_string(REQUEST_VERTICES) + " vertices";
+					break;
+				}
+				bytes += (r.G.M.size() + (r.op == "product" ? r.H.M.size() : 0)) * sizeof(int);
+				ready++;
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			pool.run(ready, [&](int i, int t) {
+				solve(requests[i], t);
+			});
+			ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			// The matrices are freed, not kept for the next window
+			for (int i = 0; i < ready; i++) {
+				Request& r = requests[i];
+				fprintf(out, "%s %s %.3f %s\n", r.id.c_str(), r.op.c_str(), r.ms, r.result.c_str());
+				r = Request();
+			}
+			fflush(out);
+			answered += ready;
+		}
+
+		if (!error.empty())
+			fprintf(out, "%s\n", error.c_str());
+		fprintf(out, "done %lld %.3f\n", answered, ms);
+		fflush(out);
+		if (!error.empty())
+			skip_to_batch(reader);
+	}
+
+	return true;
+}
+
+// Serves each client of the Unix socket in path, one at a time
+// Returns the exit code of the service
+int serve_socket(const char* path, WorkerPool& pool) {
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (server < 0 || strlen(path) >= sizeof(address.sun_path)) {
+		std::cerr << "Could not open the socket " << path << "\n";
+		return 1;
+	}
+	strcpy(address.sun_path, path);
+	unlink(path);
+	if (bind(server, (sockaddr*) &address, sizeof(address)) || listen(server, 16)) {
+		std::cerr << "Could not open the socket " << path << "\n";
+		close(server);
+		return 1;
+	}
+	signal(SIGPIPE, SIG_IGN); // A client that leaves early only ends its connection
+
+	bool running = true;
+	while (running) {
+		int client = accept(server, NULL, NULL);
+		if (client < 0)
+			continue;
+		FILE* in = fdopen(client, "r");
+		FILE* out = fdopen(dup(client), "w");
+		if (in && out)
+			running = serve(in, out, pool);
+		if (in)
+			fclose(in);
+		if (out)
+			fclose(out);
+	}
+
+	close(server);
+	unlink(path);
+	return 0;
+}
+
+int main(int argc, char* argv[]) {
+	int threads = std::max(1u, std::thread::hardware_concurrency());
+	const char* socket_path = NULL;
+	for (int k = 1; k < argc; k++) {
+		if (k + 1 < argc && !strcmp(argv[k], "--threads"))
+			threads = std::max(1, atoi(argv[++k]));
+		else if (k + 1 < argc && !strcmp(argv[k], "--socket"))
+			socket_path = argv[++k];
+	}
+
+	contexts.resize(threads);
+	WorkerPool pool(threads);
+
+	if (socket_path)
+		return serve_socket(socket_path, pool);
+	serve(stdin, stdout, pool);
+	return 0;
+}